@@ -0,0 +1,40 @@
+// caenEnum.cpp
+// Cost of translating CAEN enum values from and to their names in the configuration (caenEnumTranslator on the
+// constexpr tables generated by enum2str): lookups of names in any case, of integers given instead of a name and of
+// invalid names (both parsed as integers after the lookup fails), and names of values.
+//
+// usage: cadidaq-bench-caenEnum [lookups = 2000000]
+
+#include <CaenEnum2strTranslator.hpp>
+
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+/// ns per call of f(i) for n calls
+template <typename F>
+static double nsPerCall(F f, long n){
+  volatile std::size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < n; i++)
+    sink += f(i);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()/n;
+}
+
+int main(int argc, char** argv){
+  long n = argc > 1 ? std::atol(argv[1]) : 2000000;
+  caenEnumTranslator<CAEN_DGTZ_TriggerMode_t> triggerMode;
+  caenEnumTranslator<CAEN_DGTZ_IOLevel_t> ioLevel;
+  const std::string names[] = {"ACQ_ONLY", "disabled", "Acq_And_ExtOut", "EXTOUT_ONLY"};
+  const CAEN_DGTZ_TriggerMode_t values[] = {CAEN_DGTZ_TRGMODE_DISABLED, CAEN_DGTZ_TRGMODE_ACQ_ONLY,
+                                            CAEN_DGTZ_TRGMODE_EXTOUT_ONLY, CAEN_DGTZ_TRGMODE_ACQ_AND_EXTOUT};
+  const std::string invalid = "ACQ_ONLYY";
+
+  std::cout << "get_value (name to value):  " << nsPerCall([&](long i){ return (std::size_t)*triggerMode.get_value(names[i&3]); }, n) << " ns" << std::endl;
+  std::cout << "put_value (value to name):  " << nsPerCall([&](long i){ return triggerMode.put_value(values[i&3])->size(); }, n) << " ns" << std::endl;
+  std::cout << "get_value of an integer:     " << nsPerCall([&](long i){ return (std::size_t)*triggerMode.get_value(i&1 ? "1" : "2"); }, n) << " ns" << std::endl;
+  std::cout << "get_value of invalid name:  " << nsPerCall([&](long){ return (std::size_t)bool(triggerMode.get_value(invalid)); }, n) << " ns" << std::endl;
+  std::cout << "other type (IOLevel):       " << nsPerCall([&](long i){ return (std::size_t)*ioLevel.get_value(i&1 ? "TTL" : "nim"); }, n) << " ns" << std::endl;
+  return 0;
+}
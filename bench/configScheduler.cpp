@@ -0,0 +1,77 @@
+// configScheduler.cpp
+// Wall time of configuring several simulated digitizers sequentially and concurrently, with a latency added to each
+// device call and to opening a device as a stand-in for the bus round-trips of real boards (simulation builds only).
+//
+// usage: cadidaq-bench-configScheduler [boards = 8] [call latency us = 200] [open latency us = 20000]
+
+#include <configScheduler.hpp>
+#include <digitizer.hpp>
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+#include <boost/log/core.hpp>
+
+namespace pt = boost::property_tree;
+
+/// settings of a board touching all kinds of calls: common, per channel, masks and raw registers
+static pt::iptree boardSection(int link){
+  pt::iptree node;
+  node.put("LinkType", "usb");
+  node.put("LinkNum", link);
+  node.put("RecordLength", 1000);
+  node.put("PostTriggerSize", 50);
+  node.put("SWTriggerMode", "CAEN_DGTZ_TRGMODE_ACQ_ONLY");
+  node.put("AcquisitionMode", "CAEN_DGTZ_SW_CONTROLLED");
+  node.put("EnableChannel[0-7]", "true");
+  node.put("ChannelDCOffset[0-7]", 0x8000);
+  node.put("ChannelTriggerTreshold[0-7]", 100);
+  node.put("SetRegister[0x1080, 0x1180, 0x1280]", 5);
+  return node;
+}
+
+/// configures fresh digitizers for all sections and returns the wall time in seconds
+static double configureAll(std::vector<pt::iptree>& sections, bool parallel, uint64_t& writes){
+  std::vector<cadidaq::digitizer*> digis;
+  std::vector<pt::iptree> nodes(sections);
+  cadidaq::configScheduler scheduler;
+  for (std::size_t i = 0; i < nodes.size(); i++){
+    digis.push_back(new cadidaq::digitizer("board" + std::to_string(i)));
+    scheduler.add(digis.back(), &nodes[i]);
+  }
+  auto start = std::chrono::steady_clock::now();
+  if (!scheduler.run(parallel))
+    std::cerr << "configuration failed" << std::endl;
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  writes = 0;
+  for (auto d : digis){
+    writes += d->getWrites();
+    delete d;
+  }
+  return seconds;
+}
+
+int main(int argc, char** argv){
+  int boards = argc > 1 ? std::atoi(argv[1]) : 8;
+  std::string callLatency = argc > 2 ? argv[2] : "200";
+  std::string openLatency = argc > 3 ? argv[3] : "20000";
+  // read by the simulated device when it is opened
+  setenv("CADIDAQ_SIM_CALL_LATENCY", callLatency.c_str(), 1);
+  setenv("CADIDAQ_SIM_OPEN_LATENCY", openLatency.c_str(), 1);
+  boost::log::core::get()->set_logging_enabled(false);
+
+  std::vector<pt::iptree> sections;
+  for (int i = 0; i < boards; i++)
+    sections.push_back(boardSection(i));
+  uint64_t writes;
+  double sequential = configureAll(sections, false, writes);
+  double parallel = configureAll(sections, true, writes);
+  std::cout << boards << " boards, " << writes << " device writes, call latency " << callLatency << " us, open latency "
+            << openLatency << " us:" << std::endl
+            << "\t sequential: " << sequential << " s" << std::endl
+            << "\t parallel:   " << parallel << " s (" << sequential/parallel << "x)" << std::endl;
+  return 0;
+}
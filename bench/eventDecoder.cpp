@@ -0,0 +1,123 @@
+// eventDecoder.cpp
+// Throughput of the standard-firmware decoder on block transfers of the simulated V1720, V1751 and V1740 (simulation
+// builds only): walking the event headers, reading all samples through channelData::sample() and through the unpack
+// kernels, compared with summing the words of the buffer and with copying it.
+//
+// usage: cadidaq-bench-eventDecoder [MiB of events per board = 64] [record length = 1024]
+
+#include <eventDecoder.hpp>
+#include <sampleUnpack.hpp>
+#include <digitizer.hpp>
+#include <caen.hpp> // the simulated device (include/sim)
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+/// events read from a simulated board of the given model until there are at least the given number of bytes
+static std::vector<char> readEvents(CAEN_DGTZ_BoardModel_t model, const cadidaq::boardInfo& info, uint32_t recordLength, std::size_t bytes){
+  caen::simulation().model = model;
+  caen::simulation().modelName = info.model;
+  caen::simulation().channels = info.channels;
+  caen::simulation().groups = info.groups;
+  caen::simulation().ADCbits = info.adcBits;
+  // as many events per transfer as fit
+  caen::simulation().eventRate = 1e12;
+  caen::Digitizer* dg = caen::Digitizer::open(CAEN_DGTZ_USB, 0, 0, 0);
+  dg->setRecordLength(recordLength);
+  dg->setChannelEnableMask(0xFF);
+  dg->setGroupEnableMask(0xFF);
+  dg->setMaxNumEventsBLT(1024);
+  caen::Digitizer::ReadoutBuffer buffer = dg->mallocReadoutBuffer();
+  std::vector<char> data;
+  data.reserve(bytes + buffer.size);
+  dg->startAcquisition();
+  while (data.size() < bytes){
+    dg->readData(buffer, CAEN_DGTZ_SLAVE_TERMINATED_READOUT_MBLT);
+    data.insert(data.end(), buffer.data, buffer.data + buffer.dataSize);
+  }
+  dg->freeReadoutBuffer(buffer);
+  delete dg;
+  return data;
+}
+
+/// MiB/s and events/s of f over the buffer (best of 3, after a warm-up)
+template <typename F>
+static void report(const char* what, double mib, uint64_t nEvents, F f){
+  f();
+  double best = 1e9;
+  for (int r = 0; r < 3; r++){
+    auto start = std::chrono::steady_clock::now();
+    f();
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::cout << "  " << what << mib/best << " MiB/s, " << nEvents/best*1e-6 << " Mevents/s" << std::endl;
+}
+
+static void board(CAEN_DGTZ_BoardModel_t modelNo, const char* model, uint32_t channels, uint32_t groups, uint32_t adcBits, std::size_t bytes, uint32_t recordLength){
+  cadidaq::boardInfo info = {};
+  info.model = model;
+  info.channels = channels;
+  info.groups = groups;
+  info.channelsPerGroup = channels/groups;
+  info.adcBits = adcBits;
+  info.is751Family = adcBits == 10;
+  std::vector<char> data = readEvents(modelNo, info, recordLength, bytes);
+  cadidaq::standardDecoder decoder(info, 0xFF, recordLength);
+  double mib = data.size()/1048576.;
+  volatile uint64_t sink = 0;
+  uint64_t nEvents = decoder.decode(data.data(), data.size(), [](const cadidaq::eventView&){});
+  std::cout << "  " << nEvents << " events in " << mib << " MiB, " << decoder.getCorruptBuffers() << " corrupt buffers, "
+            << decoder.getUnexpectedEvents() << " unexpected events" << std::endl;
+
+  report("headers only:             ", mib, nEvents, [&]{
+    uint64_t sum = 0;
+    decoder.decode(data.data(), data.size(), [&](const cadidaq::eventView& ev){ sum += ev.time; });
+    sink += sum;
+  });
+  report("all samples via sample(): ", mib, nEvents, [&]{
+    uint64_t sum = 0;
+    decoder.decode(data.data(), data.size(), [&](const cadidaq::eventView& ev){
+      for (uint32_t ch = 0; ch < channels; ch++){
+        cadidaq::channelData d = ev.channel(ch);
+        for (uint32_t i = 0; i < d.nSamples; i++)
+          sum += d.sample(i);
+      }
+    });
+    sink += sum;
+  });
+  cadidaq::sampleBuffer samples;
+  report("all channels unpacked:    ", mib, nEvents, [&]{
+    decoder.decode(data.data(), data.size(), [&](const cadidaq::eventView& ev){
+      for (uint32_t ch = 0; ch < channels; ch++)
+        sink += samples.unpack(ev.channel(ch))[5];
+    });
+  });
+  report("reference, sum of words:  ", mib, nEvents, [&]{
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(data.data());
+    uint64_t sum = 0;
+    for (std::size_t i = 0; i < data.size()/4; i++)
+      sum += words[i];
+    sink += sum;
+  });
+  std::vector<char> copy(data.size());
+  report("reference, memcpy:        ", mib, nEvents, [&]{
+    std::memcpy(copy.data(), data.data(), data.size());
+    sink += copy[77];
+  });
+}
+
+int main(int argc, char** argv){
+  std::size_t mib = argc > 1 ? std::atol(argv[1]) : 64;
+  uint32_t recordLength = argc > 2 ? std::atoi(argv[2]) : 1024;
+  std::cout << "V1720, 8 channels of 12 bits:" << std::endl;
+  board(CAEN_DGTZ_V1720, "V1720", 8, 1, 12, mib << 20, recordLength);
+  std::cout << "V1751, 8 channels of 10 bits:" << std::endl;
+  board(CAEN_DGTZ_V1751, "V1751", 8, 1, 10, mib << 20, recordLength);
+  std::cout << "V1740, 64 channels of 12 bits in 8 groups:" << std::endl;
+  board(CAEN_DGTZ_V1740, "V1740", 64, 8, 12, mib << 20, recordLength);
+  return 0;
+}
@@ -0,0 +1,82 @@
+// integers.cpp
+// Parsing and formatting of the integers in the configuration (str2hex, hex2str and the hexTranslator of all int and
+// uint32_t settings) compared with the stream and lexical_cast based conversions they replaced.
+//
+// usage: cadidaq-bench-integers [conversions = 2000000]
+
+#include <hexTranslator.hpp>
+#include <helper.hpp>
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string.hpp>
+
+namespace baseline {
+  /// str2hex before the parsing without streams
+  boost::optional<uint32_t> str2hex(std::string str){
+    boost::erase_all(str, " ");
+    if (str.empty())
+      return boost::none;
+    uint32_t i = 0;
+    if (boost::istarts_with(str, "0x")){
+      std::stringstream ss(str);
+      ss >> std::hex >> i;
+      return i;
+    }
+    try{
+      i = boost::lexical_cast<uint32_t>(str);
+    }
+    catch (boost::bad_lexical_cast&){
+      return boost::none;
+    }
+    return i;
+  }
+
+  /// hex2str before the formatting without streams
+  std::string hex2str(uint32_t i){
+    std::stringstream s;
+    s << std::hex << std::showbase << i;
+    return s.str();
+  }
+}
+
+/// ns per call of f(i) for n calls
+template <typename F>
+static double nsPerCall(F f, long n){
+  volatile uint64_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < n; i++)
+    sink += f(i);
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()/n;
+}
+
+static void report(const char* what, double before, double now){
+  std::cout << what << before << " ns before, " << now << " ns now (" << before/now << "x)" << std::endl;
+}
+
+int main(int argc, char** argv){
+  long n = argc > 1 ? std::atol(argv[1]) : 2000000;
+  std::vector<std::string> hex, dec;
+  for (uint32_t i = 0; i < 256; i++){
+    hex.push_back(hex2str(0x8000u + i*0x1234567u));
+    dec.push_back(std::to_string(i*12345));
+  }
+  hexTranslator<uint32_t> translator;
+
+  report("str2hex of hex:         ", nsPerCall([&](long i){ return *baseline::str2hex(hex[i&255]); }, n),
+                                   nsPerCall([&](long i){ return *str2hex(hex[i&255]); }, n));
+  report("str2hex of decimal:     ", nsPerCall([&](long i){ return *baseline::str2hex(dec[i&255]); }, n),
+                                   nsPerCall([&](long i){ return *str2hex(dec[i&255]); }, n));
+  report("hex2str:                ", nsPerCall([&](long i){ return baseline::hex2str(i*0x9E3779B9u).size(); }, n),
+                                   nsPerCall([&](long i){ return hex2str(uint32_t(i*0x9E3779B9u)).size(); }, n));
+  std::cout << "hexTranslator, hex:     " << nsPerCall([&](long i){ return *translator.get_value(hex[i&255]); }, n) << " ns" << std::endl;
+  std::cout << "hexTranslator, decimal: " << nsPerCall([&](long i){ return *translator.get_value(dec[i&255]); }, n) << " ns" << std::endl;
+  std::cout << "hexTranslator, output:  " << nsPerCall([&](long i){ return translator.put_value(uint32_t(i*0x9E3779B9u))->size(); }, n) << " ns" << std::endl;
+  return 0;
+}
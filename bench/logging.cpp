@@ -0,0 +1,64 @@
+// logging.cpp
+// Cost at the call site of a debug record of the *_LOG_* macros: stripped at compile time (CADIDAQ_LOG_MIN_SEVERITY,
+// set by CADIDAQ_STRIP_DEBUG_LOGGING), rejected by the runtime filter of the console sink, and written through the
+// synchronous or the asynchronous console sink (printed to the console: redirect it, e.g. 2>/dev/null).
+//
+// usage: cadidaq-bench-logging [records = 200000] [emit = 0|1]
+
+#include <logging.hpp>
+
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+typedef std::chrono::steady_clock benchClock;
+
+/// as the repository's macros (e.g. DG_LOG_DEBUG) expand with the default threshold
+static void unstripped(boost::log::trivial::severity_level severity, int n){
+  for (int i = 0; i < n; i++)
+    CADIDAQ_LOG_CHANNEL_SEV(lg, "dig", severity) << "channel " << i%64 << ": value " << i;
+}
+
+static void stripped(int n);
+
+static double nsPerRecord(benchClock::time_point start, int n){
+  return std::chrono::duration<double, std::nano>(benchClock::now() - start).count()/n;
+}
+
+int main(int argc, char** argv){
+  int n = argc > 1 ? std::atoi(argv[1]) : 200000;
+  bool emit = argc > 2 && std::atoi(argv[2]);
+  init_console_logging();
+
+  auto start = benchClock::now();
+  stripped(n);
+  std::cout << "stripped at compile time:       " << nsPerRecord(start, n) << " ns per record" << std::endl;
+  // trace is below the minimum severity of every channel
+  start = benchClock::now();
+  unstripped(boost::log::trivial::trace, n);
+  std::cout << "rejected by the runtime filter: " << nsPerRecord(start, n) << " ns per record" << std::endl;
+  if (!emit)
+    return 0;
+
+  start = benchClock::now();
+  unstripped(boost::log::trivial::debug, n);
+  double sync = nsPerRecord(start, n);
+  init_async_console_logging(65536, false);
+  start = benchClock::now();
+  unstripped(boost::log::trivial::debug, n);
+  double async = nsPerRecord(start, n);
+  stop_logging();
+  std::cout << "written, synchronous sink:      " << sync << " ns per record" << std::endl;
+  std::cout << "written, asynchronous sink:     " << async << " ns per record in the calling thread" << std::endl;
+  return 0;
+}
+
+// the threshold of a build with CADIDAQ_STRIP_DEBUG_LOGGING (the macro is evaluated where CADIDAQ_LOG_CHANNEL_SEV expands)
+#undef CADIDAQ_LOG_MIN_SEVERITY
+#define CADIDAQ_LOG_MIN_SEVERITY 2
+
+static void stripped(int n){
+  for (int i = 0; i < n; i++)
+    CADIDAQ_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::debug) << "channel " << i%64 << ": value " << i;
+}
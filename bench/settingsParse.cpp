@@ -0,0 +1,80 @@
+// settingsParse.cpp
+// Time to parse a generated configuration section of a 64-channel board with thousands of keys: every setting given
+// for many overlapping channel ranges in all notations, raw register writes and unknown keys. Each key is matched to
+// its setting through the per-section key index of settingsBase. The records logged while parsing go through the
+// console sink into a discarding buffer; cadidaq-bench-settingsParseStripped is the same program built with debug and
+// trace logging stripped at compile time, as by CADIDAQ_STRIP_DEBUG_LOGGING.
+//
+// usage: cadidaq-bench-settingsParse[Stripped] [register writes = 1500] [repetitions = 20]
+
+#include <settings.hpp>
+#include <logging.hpp>
+
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <streambuf>
+
+namespace pt = boost::property_tree;
+
+/// counts and discards what is written to it
+class nullBuffer : public std::streambuf {
+public:
+  std::size_t bytes = 0;
+protected:
+  int_type overflow(int_type c) override { bytes++; return traits_type::not_eof(c); }
+  std::streamsize xsputn(const char*, std::streamsize n) override { bytes += n; return n; }
+};
+
+/// vector settings for all channel ranges a-b of 64 channels in four notations, register writes and unknown keys
+static pt::iptree generateSection(int nRegisters){
+  const char* keys[]   = {"ChannelDCOffset", "ChannelTriggerTreshold", "EnableChannel", "ChannelSelfTrigger",
+                          "DPPPreTriggerSize", "ChannelTriggerPolarity", "DPPChannelPulsePolarity", "UnknownVector"};
+  const char* values[] = {"100", "200", "true", "ACQ_ONLY", "50", "RisingEdge", "PulsePolarityPositive", "1"};
+  const char* notations[][3] = {{"[", "-", "]"}, {"[", ",", "]"}, {"(", "-", ")"}, {"[", ", ", "]"}};
+  pt::iptree node;
+  int n = 0;
+  for (auto& f : notations)
+    for (int a = 0; a < 64; a++)
+      for (int b = a; b < 64; b++, n++)
+        node.add(std::string(keys[n%8]) + f[0] + std::to_string(a) + f[1] + std::to_string(b) + f[2], values[n%8]);
+  char key[32];
+  for (int i = 0; i < nRegisters; i++){
+    std::snprintf(key, sizeof(key), "SetRegister[0x%x]", 0x1000 + 4*i);
+    node.add(key, "5");
+  }
+  for (int i = 0; i < 500; i++)
+    node.add("Unknown" + std::to_string(i), "1");
+  return node;
+}
+
+int main(int argc, char** argv){
+  int nRegisters = argc > 1 ? std::atoi(argv[1]) : 1500;
+  int repetitions = argc > 2 ? std::atoi(argv[2]) : 20;
+  // format every record as the console sink does, without the terminal's cost
+  nullBuffer sink;
+  std::streambuf* console = std::clog.rdbuf(&sink);
+  init_console_logging();
+
+  pt::iptree section = generateSection(nRegisters);
+  double best = 1e9;
+  std::size_t remaining = 0, registers = 0;
+  for (int r = 0; r < repetitions; r++){
+    // parsing consumes the keys: work on a copy
+    pt::iptree node(section);
+    cadidaq::registerSettings reg("bench", 64);
+    auto start = std::chrono::steady_clock::now();
+    reg.parse(&node);
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    remaining = node.size();
+    registers = reg.registerValues.size();
+  }
+  std::clog.rdbuf(console);
+  std::cout << (CADIDAQ_LOG_MIN_SEVERITY >= 2 ? "debug logging stripped, " : "debug logging compiled in, ")
+            << sink.bytes/repetitions << " bytes logged per section" << std::endl;
+  std::cout << section.size() << " keys (" << remaining << " not recognized, " << registers << " register writes): "
+            << best*1e3 << " ms per section, " << best/section.size()*1e9 << " ns per key (best of " << repetitions << ")" << std::endl;
+  return 0;
+}
@@ -0,0 +1,118 @@
+// spscRing.cpp
+// Throughput and handoff latency of cadidaq::spscRing in the pattern of the readout engine: a producer fills buffers
+// and hands them to a consumer, which reads them and returns them through a second ring.
+//
+// usage: cadidaq-bench-spscRing [buffer KiB = 1024] [buffers = 4] [seconds = 2]
+
+#include <spscRing.hpp>
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+typedef std::chrono::steady_clock benchClock;
+
+static uint64_t nowNs(){
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(benchClock::now().time_since_epoch()).count();
+}
+
+struct buffer {
+  std::vector<uint64_t> words;
+  uint64_t              pushed; ///< time of the handoff in ns
+};
+
+/// buffers of the given size handed over for the given time: prints GB/s and the distribution of push-to-pop latencies
+static void buffers(std::size_t words, std::size_t nBuffers, double seconds){
+  std::vector<buffer> storage(nBuffers);
+  for (auto& b : storage)
+    b.words.assign(words, 0);
+  cadidaq::spscRing<buffer*> filled(nBuffers), free(nBuffers);
+  for (auto& b : storage)
+    free.push(&b);
+
+  std::atomic<bool> running(true);
+  std::vector<uint64_t> latencies;
+  latencies.reserve(1 << 20);
+  uint64_t handed = 0, checksum = 0;
+  std::thread consumer([&](){
+    buffer* b;
+    for (;;){
+      if (!filled.pop(b)){
+        if (!running && filled.empty())
+          break;
+        std::this_thread::yield();
+        continue;
+      }
+      latencies.push_back(nowNs() - b->pushed);
+      for (uint64_t w : b->words)
+        checksum += w;
+      handed++;
+      free.push(b);
+    }
+  });
+
+  auto start = benchClock::now();
+  auto stop = start + std::chrono::duration_cast<benchClock::duration>(std::chrono::duration<double>(seconds));
+  uint64_t n = 0;
+  buffer* b;
+  while (benchClock::now() < stop){
+    if (!free.pop(b)){
+      std::this_thread::yield();
+      continue;
+    }
+    std::fill(b->words.begin(), b->words.end(), n++);
+    b->pushed = nowNs();
+    filled.push(b);
+  }
+  running = false;
+  consumer.join();
+  double elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p){return latencies.empty() ? 0 : latencies[std::min(latencies.size() - 1, (std::size_t)(p*latencies.size()))];};
+  std::cout << nBuffers << " buffers of " << words*sizeof(uint64_t)/1024 << " KiB: " << handed << " handed over in " << elapsed << " s, "
+            << handed*words*sizeof(uint64_t)/elapsed*1e-9 << " GB/s (checksum " << checksum << ")" << std::endl
+            << "\t handoff latency: p50 " << percentile(0.5)*1e-3 << " us, p99 " << percentile(0.99)*1e-3 << " us, max "
+            << (latencies.empty() ? 0 : latencies.back())*1e-3 << " us" << std::endl;
+}
+
+/// single values through one ring: prints the rate of pushes and pops
+static void values(std::size_t capacity, uint64_t n){
+  cadidaq::spscRing<uint64_t> ring(capacity);
+  uint64_t sum = 0;
+  auto start = benchClock::now();
+  std::thread consumer([&](){
+    uint64_t v;
+    for (uint64_t i = 0; i < n;){
+      if (ring.pop(v)){
+        sum += v;
+        i++;
+      } else
+        std::this_thread::yield();
+    }
+  });
+  for (uint64_t i = 0; i < n;){
+    if (ring.push(i))
+      i++;
+    else
+      std::this_thread::yield();
+  }
+  consumer.join();
+  double elapsed = std::chrono::duration<double>(benchClock::now() - start).count();
+  std::cout << n << " values through a ring of " << capacity << ": " << n/elapsed*1e-6 << " M/s"
+            << (sum == n*(n - 1)/2 ? "" : " (WRONG SUM)") << std::endl;
+}
+
+int main(int argc, char** argv){
+  std::size_t kib = argc > 1 ? std::atol(argv[1]) : 1024;
+  std::size_t nBuffers = argc > 2 ? std::atol(argv[2]) : 4;
+  double seconds = argc > 3 ? std::atof(argv[3]) : 2.;
+  std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+  buffers(std::max<std::size_t>(kib, 1)*1024/sizeof(uint64_t), std::max<std::size_t>(nBuffers, 2), seconds);
+  values(1024, 50000000);
+  return 0;
+}
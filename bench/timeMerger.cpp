@@ -0,0 +1,166 @@
+// timeMerger.cpp
+// Throughput of cadidaq::timeMerger on synthetic streams of DPP-sized records from several boards, compared with a
+// binary heap over all waiting records (std::priority_queue) applying the same release rule. Boards run at rates
+// differing by up to 16x with offset clocks, deliver their records in buffers covering 20-200 us each, and a fraction
+// of records (stragglers) lag their board's latest time by up to 5 us.
+//
+// usage: cadidaq-bench-timeMerger [boards = 8] [records = 5000000] [window ns = 500000] [straggler fraction = 0.001]
+
+#include <timeMerger.hpp>
+
+#include <vector>
+#include <queue>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <cstdlib>
+
+/// a decoded hit, the size of dppHit
+struct record {
+  uint64_t time;
+  uint32_t counter;
+  uint16_t energy, chargeLong, fineTime, flags;
+  uint8_t  channel, board;
+};
+
+/// records of one board delivered in one buffer
+struct chunk {
+  std::size_t board, begin, end;
+};
+
+/// per-board streams in time order (but for the stragglers), as the buffers of the boards arrive
+static void generate(std::size_t nBoards, std::size_t total, double stragglers, std::vector<record>& records, std::vector<chunk>& chunks){
+  std::mt19937_64 rng(25);
+  std::vector<double> rate(nBoards);
+  double rateSum = 0;
+  for (std::size_t b = 0; b < nBoards; b++)
+    rateSum += rate[b] = 1 << (b % 5);
+  std::vector<std::vector<record>> streams(nBoards);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::uniform_int_distribution<uint64_t> lag(1, 5000);
+  for (std::size_t b = 0; b < nBoards; b++){
+    // 10 records per us from all boards together
+    std::exponential_distribution<double> gap(rate[b]/rateSum*10.0/1000.0);
+    double t = 1000.0*b;
+    std::size_t n = total*rate[b]/rateSum;
+    for (std::size_t i = 0; i < n; i++){
+      t += gap(rng);
+      record r = {};
+      r.time = t;
+      r.counter = i;
+      r.board = b;
+      r.channel = i % 16;
+      if (i > 0 && uniform(rng) < stragglers)
+        r.time -= std::min<uint64_t>(r.time, lag(rng));
+      streams[b].push_back(r);
+    }
+  }
+  // buffers of 20-200 us, from the board whose buffers reach least far
+  std::vector<std::size_t> next(nBoards, 0);
+  std::vector<double> until(nBoards, 0);
+  std::uniform_real_distribution<double> span(20000, 200000);
+  for (;;){
+    std::size_t board = nBoards;
+    for (std::size_t b = 0; b < nBoards; b++)
+      if (next[b] < streams[b].size() && (board == nBoards || until[b] < until[board]))
+        board = b;
+    if (board == nBoards)
+      break;
+    until[board] += span(rng);
+    chunk c = {board, records.size(), 0};
+    while (next[board] < streams[board].size() && streams[board][next[board]].time < until[board])
+      records.push_back(streams[board][next[board]++]);
+    c.end = records.size();
+    if (c.end > c.begin)
+      chunks.push_back(c);
+  }
+}
+
+/// receives the merged stream: counts records and those out of time order
+struct sink {
+  uint64_t latest = 0, n = 0, disorder = 0;
+  void operator()(const record& r, std::size_t){
+    if (r.time < latest)
+      disorder++;
+    else
+      latest = r.time;
+    n++;
+  }
+};
+
+/// the same release rule on a binary heap of all waiting records
+struct heapMerger {
+  struct later {
+    bool operator()(const record& a, const record& b) const {return a.time > b.time;}
+  };
+  std::priority_queue<record, std::vector<record>, later> heap;
+  uint64_t window, maxSeen = 0, lastReleased = 0;
+  bool released = false;
+
+  explicit heapMerger(uint64_t window) : window(window) {}
+  template <typename F>
+  void push(std::size_t input, const record& r, F emit){
+    if (released && r.time < lastReleased){
+      emit(r, input);
+      return;
+    }
+    heap.push(r);
+    maxSeen = std::max(maxSeen, r.time);
+  }
+  template <typename F>
+  void release(F emit){
+    if (maxSeen < window)
+      return;
+    for (uint64_t limit = maxSeen - window; !heap.empty() && heap.top().time <= limit; heap.pop()){
+      lastReleased = heap.top().time;
+      released = true;
+      emit(heap.top(), 0);
+    }
+  }
+  template <typename F>
+  void flush(F emit){
+    for (; !heap.empty(); heap.pop())
+      emit(heap.top(), 0);
+  }
+};
+
+/// ns per record to merge all chunks, releasing after each
+template <typename M>
+static double merge(M& merger, const std::vector<record>& records, const std::vector<chunk>& chunks, sink& out){
+  auto start = std::chrono::steady_clock::now();
+  for (const chunk& c : chunks){
+    for (std::size_t i = c.begin; i < c.end; i++)
+      merger.push(c.board, records[i], std::ref(out));
+    merger.release(std::ref(out));
+  }
+  merger.flush(std::ref(out));
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()/records.size();
+}
+
+int main(int argc, char** argv){
+  std::size_t nBoards = argc > 1 ? std::atoi(argv[1]) : 8;
+  std::size_t total = argc > 2 ? std::atol(argv[2]) : 5000000;
+  uint64_t window = argc > 3 ? std::atol(argv[3]) : 500000;
+  double stragglers = argc > 4 ? std::atof(argv[4]) : 0.001;
+  std::vector<record> records;
+  std::vector<chunk> chunks;
+  generate(nBoards, total, stragglers, records, chunks);
+  std::cout << nBoards << " boards, " << records.size() << " records in " << chunks.size() << " buffers, window " << window << " ns" << std::endl;
+
+  double tree = 1e9, heap = 1e9;
+  for (int r = 0; r < 3; r++){
+    cadidaq::timeMerger<record> merger(nBoards, window, 1 << 18);
+    sink out;
+    tree = std::min(tree, merge(merger, records, chunks, out));
+    if (r == 0)
+      std::cout << "tournament tree: " << out.n << " records out, " << merger.getLate() << " late, " << merger.getForced()
+                << " forced, " << out.disorder << " out of order, at most " << merger.highWaterMark() << " waiting" << std::endl;
+    heapMerger reference(window);
+    sink heapOut;
+    heap = std::min(heap, merge(reference, records, chunks, heapOut));
+  }
+  std::cout << "tournament tree: " << tree << " ns per record (" << 1e3/tree << " Mrecords/s)" << std::endl;
+  std::cout << "binary heap:     " << heap << " ns per record (" << 1e3/heap << " Mrecords/s)" << std::endl;
+  return 0;
+}
@@ -35,17 +35,23 @@
 #    BLACKLIST      <blacklist for enum constants>
 #    USE_CONSTEXPR  <whether to use constexpr or not (default: off)>
 #    USE_C_STRINGS  <whether to use c strings instead of std::string or not (default: off)>
+#
+# Without USE_CONSTEXPR, a class CLASS_NAME is generated holding one boost::bimap per enum which is filled at runtime.
+# With USE_CONSTEXPR (implies USE_C_STRINGS), a class template CLASS_NAME<enum> is specialized for every enum holding a
+# constexpr array 'entries' of {name, value} sorted case-insensitively by name, its 'size' and the 'rootLength' of the
+# prefix common to all names. The constexpr function templates FUNC_NAME(value) (enum -> name) and findName<enum>(name)
+# (case-insensitive binary search of a name without that prefix) operate on these tables.
 function( enum2str_generate )
   set( options        USE_CONSTEXPR USE_C_STRINGS)
   set( oneValueArgs   PATH CLASS_NAME FUNC_NAME NAMESPACE INDENT_STR )
   set( multiValueArgs INCLUDES ENUMS BLACKLIST )
   cmake_parse_arguments( OPTS "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
 
-  if( OPTS_USE_C_STRINGS )
+  if( OPTS_USE_C_STRINGS OR OPTS_USE_CONSTEXPR )
     set( STRING_TYPE "const char *" )
-  else( OPTS_USE_C_STRINGS )
+  else( OPTS_USE_C_STRINGS OR OPTS_USE_CONSTEXPR )
     set( STRING_TYPE "std::string " )
-  endif( OPTS_USE_C_STRINGS )
+  endif( OPTS_USE_C_STRINGS OR OPTS_USE_CONSTEXPR )
 
   message( STATUS "Generating enum2str files" )
 
@@ -211,20 +217,18 @@ function( enum2str_add )
   endforeach( I IN LISTS ENUMS_TO_USE )
 
 
-   # add a boost::bimap for bi-directional lookup
-  IF(NOT OPTS_USE_CONSTEXPR )
-    file( APPEND "${HPP_FILE}" "${IND}typedef boost::bimap< ${STRING_TYPE}, ${ARGV0} > bm_${ARGV0}_type;\n" )
-    file( APPEND "${HPP_FILE}" "${IND}bm_${ARGV0}_type bm_${ARGV0};\n" )
-    file( APPEND "${HPP_FILE}" "${IND}bm_${ARGV0}_type* getBimap(${ARGV0}){return &bm_${ARGV0};}\n" )
-
-    file( APPEND "${TRANSL_FILE}" "" )
-
+   # add the translator for property trees
     file( APPEND "${TRANSL_FILE}" "template<typename Ch, typename Traits, typename Alloc>\n")
     file( APPEND "${TRANSL_FILE}" "struct translator_between<std::basic_string< Ch, Traits, Alloc >, ${ARGV0}>\n")
     file( APPEND "${TRANSL_FILE}" "{\n")
     file( APPEND "${TRANSL_FILE}" "typedef caenEnumTranslator<${ARGV0}> type;\n")
     file( APPEND "${TRANSL_FILE}" "};\n")
 
+   # add a boost::bimap for bi-directional lookup
+  IF(NOT OPTS_USE_CONSTEXPR )
+    file( APPEND "${HPP_FILE}" "${IND}typedef boost::bimap< ${STRING_TYPE}, ${ARGV0} > bm_${ARGV0}_type;\n" )
+    file( APPEND "${HPP_FILE}" "${IND}bm_${ARGV0}_type bm_${ARGV0};\n" )
+    file( APPEND "${HPP_FILE}" "${IND}bm_${ARGV0}_type* getBimap(${ARGV0}){return &bm_${ARGV0};}\n" )
 
     file( APPEND "${CPP_FILE}" "/*!\n * \\brief bimap of ${STRING_TYPE} and enum ${ARGV0}\n */\n" )
 
@@ -240,6 +244,54 @@ function( enum2str_add )
       file( APPEND "${CPP_FILE}" "${IND}bm_${ARGV0}.insert( bm_${ARGV0}_type::value_type(\"${I}\",${PADDING} ${ENUM_NS}${I})); \n" )
     endforeach( I IN LISTS ENUMS_TO_USE )
     file( APPEND "${CPP_FILE}" "\n\n" )
+   else( NOT OPTS_USE_CONSTEXPR )
+    # sort the constants case-insensitively (a space sorts before any character of an identifier)
+    set( SORTED )
+    foreach( I IN LISTS ENUMS_TO_USE )
+      string( TOUPPER "${I}" UPPER )
+      list( APPEND SORTED "${UPPER} ${I}" )
+    endforeach( I IN LISTS ENUMS_TO_USE )
+    list( SORT SORTED )
+
+    # find the prefix common to all constants (e.g. "CAEN_DGTZ_")
+    list( GET ENUMS_TO_USE 0 ROOT )
+    foreach( I IN LISTS ENUMS_TO_USE )
+      string( LENGTH "${ROOT}" ROOT_LEN )
+      string( LENGTH "${I}" LEN )
+      if( LEN LESS ROOT_LEN )
+        set( ROOT_LEN ${LEN} )
+      endif( LEN LESS ROOT_LEN )
+      set( PREFIX_LEN 0 )
+      while( PREFIX_LEN LESS ROOT_LEN )
+        string( SUBSTRING "${ROOT}" ${PREFIX_LEN} 1 C1 )
+        string( SUBSTRING "${I}" ${PREFIX_LEN} 1 C2 )
+        if( NOT C1 STREQUAL C2 )
+          break()
+        endif( NOT C1 STREQUAL C2 )
+        math( EXPR PREFIX_LEN "${PREFIX_LEN} + 1" )
+      endwhile( PREFIX_LEN LESS ROOT_LEN )
+      string( SUBSTRING "${ROOT}" 0 ${PREFIX_LEN} ROOT )
+    endforeach( I IN LISTS ENUMS_TO_USE )
+    string( LENGTH "${ROOT}" ROOT_LEN )
+
+    file( APPEND "${HPP_FILE}" "template <> struct ${OPTS_CLASS_NAME}< ${ARGV0} > {\n" )
+    list( LENGTH ENUMS_TO_USE NUM_CONSTANTS )
+    file( APPEND "${HPP_FILE}" "${IND}static constexpr std::size_t size = ${NUM_CONSTANTS};\n" )
+    file( APPEND "${HPP_FILE}" "${IND}static constexpr std::size_t rootLength = ${ROOT_LEN}; // \"${ROOT}\"\n" )
+    file( APPEND "${HPP_FILE}" "${IND}static constexpr ${OPTS_CLASS_NAME}Entry< ${ARGV0} > entries[] = {\n" )
+    foreach( I IN LISTS SORTED )
+      string( REGEX REPLACE "^[^ ]* " "" I "${I}" )
+      set( PADDING )
+      string( LENGTH "${I}" LEN )
+      math( EXPR TO_PAD "${MAX_LENGTH} - ${LEN}" )
+      foreach( J RANGE ${TO_PAD} )
+        string( APPEND PADDING " " )
+      endforeach( J RANGE ${TO_PAD} )
+      file( APPEND "${HPP_FILE}" "${IND}${IND}{\"${I}\",${PADDING} ${ENUM_NS}${I}},\n" )
+    endforeach( I IN LISTS SORTED )
+    file( APPEND "${HPP_FILE}" "${IND}};\n};\n\n" )
+
+    file( APPEND "${CPP_FILE}" "constexpr ${OPTS_CLASS_NAME}Entry< ${ARGV0} > ${OPTS_CLASS_NAME}< ${ARGV0} >::entries[];\n" )
    endif( NOT OPTS_USE_CONSTEXPR )
 
 
@@ -255,29 +307,45 @@ function( enum2str_init )
   file( APPEND "${HPP_FILE}" "  * \\warning This is an automatically generated file!\n" )
   file( APPEND "${HPP_FILE}" "  */\n\n" )
   file( APPEND "${HPP_FILE}" "#pragma once\n\n// clang-format off\n\n" )
-  file( APPEND "${HPP_FILE}" "#include <string>\n" )
-  file( APPEND "${HPP_FILE}" "#include <boost/bimap.hpp>\n" )
+  if( NOT OPTS_USE_CONSTEXPR )
+    file( APPEND "${HPP_FILE}" "#include <string>\n" )
+    file( APPEND "${HPP_FILE}" "#include <boost/bimap.hpp>\n" )
+  else( NOT OPTS_USE_CONSTEXPR )
+    file( APPEND "${HPP_FILE}" "#include <cstddef>\n" )
+  endif( NOT OPTS_USE_CONSTEXPR )
 
   foreach( I IN LISTS OPTS_INCLUDES )
     file( APPEND "${HPP_FILE}" "#include <${I}>\n" )
   endforeach( I IN LISTS OPTS_INCLUDES )
 
   file( APPEND "${HPP_FILE}" "\nnamespace ${OPTS_NAMESPACE} {\n\n" )
-  file( APPEND "${HPP_FILE}" "class ${OPTS_CLASS_NAME} {\n" )
-  file( APPEND "${HPP_FILE}" " public:\n" )
-  file( APPEND "${HPP_FILE}" " ${OPTS_CLASS_NAME}();\n" )
+  file( WRITE  "${CPP_FILE}" "/*!\n" )
+  file( APPEND "${CPP_FILE}" "  * \\file ${OPTS_CLASS_NAME}.cpp\n" )
+  file( APPEND "${CPP_FILE}" "  * \\warning This is an automatically generated file!\n" )
+  file( APPEND "${CPP_FILE}" "  */\n\n" )
 
   if( NOT OPTS_USE_CONSTEXPR )
-    file( WRITE  "${CPP_FILE}" "/*!\n" )
-    file( APPEND "${CPP_FILE}" "  * \\file ${OPTS_CLASS_NAME}.cpp\n" )
-    file( APPEND "${CPP_FILE}" "  * \\warning This is an automatically generated file!\n" )
-    file( APPEND "${CPP_FILE}" "  */\n\n" )
+    file( APPEND "${HPP_FILE}" "class ${OPTS_CLASS_NAME} {\n" )
+    file( APPEND "${HPP_FILE}" " public:\n" )
+    file( APPEND "${HPP_FILE}" " ${OPTS_CLASS_NAME}();\n" )
+
     file( APPEND "${CPP_FILE}" "#pragma clang diagnostic push\n" )
     file( APPEND "${CPP_FILE}" "#pragma clang diagnostic ignored \"-Wcovered-switch-default\"\n\n" )
     file( APPEND "${CPP_FILE}" "#include \"${OPTS_CLASS_NAME}.hpp\"\n\n// clang-format off\n\n" )
     file( APPEND "${CPP_FILE}" "namespace ${OPTS_NAMESPACE} {\n\n" )
     file( APPEND "${CPP_FILE}" "${OPTS_CLASS_NAME}::${OPTS_CLASS_NAME}(){\n" )
-
+  else( NOT OPTS_USE_CONSTEXPR )
+    file( APPEND "${HPP_FILE}" "/// name and value of an enum constant\n" )
+    file( APPEND "${HPP_FILE}" "template <typename E> struct ${OPTS_CLASS_NAME}Entry {\n" )
+    file( APPEND "${HPP_FILE}" "${IND}const char* name;\n" )
+    file( APPEND "${HPP_FILE}" "${IND}E           value;\n" )
+    file( APPEND "${HPP_FILE}" "};\n\n" )
+    file( APPEND "${HPP_FILE}" "/// table of the constants of an enum sorted case-insensitively by name, specialized for every generated enum\n" )
+    file( APPEND "${HPP_FILE}" "template <typename E> struct ${OPTS_CLASS_NAME};\n\n" )
+
+    # out-of-class definitions of the tables (needed in C++11 if the tables are used at runtime)
+    file( APPEND "${CPP_FILE}" "#include \"${OPTS_CLASS_NAME}.hpp\"\n\n// clang-format off\n\n" )
+    file( APPEND "${CPP_FILE}" "namespace ${OPTS_NAMESPACE} {\n\n" )
   endif( NOT OPTS_USE_CONSTEXPR )
 
   file( WRITE  "${TRANSL_FILE}" "/*!\n" )
@@ -304,10 +372,37 @@ function( enum2str_end )
 
   file( APPEND "${TRANSL_FILE}" "}\n}\n")
 
-  file( APPEND "${HPP_FILE}" "};\n\n}\n\n// clang-format on\n" )
   if( NOT OPTS_USE_CONSTEXPR )
+    file( APPEND "${HPP_FILE}" "};\n\n}\n\n// clang-format on\n" )
     file( APPEND "${CPP_FILE}" "\n}\n}\n" )
     file( APPEND "${CPP_FILE}" "// clang-format on\n\n#pragma clang diagnostic pop\n" )
+  else( NOT OPTS_USE_CONSTEXPR )
+    set( T "${OPTS_CLASS_NAME}<E>" )
+    file( APPEND "${HPP_FILE}" "namespace detail {\n" )
+    file( APPEND "${HPP_FILE}" "${IND}constexpr char toUpper(char c){ return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c; }\n" )
+    file( APPEND "${HPP_FILE}" "${IND}/// case-insensitive comparison of two strings, <0, 0 or >0 like strcmp\n" )
+    file( APPEND "${HPP_FILE}" "${IND}constexpr int compareNoCase(const char* a, const char* b){\n" )
+    file( APPEND "${HPP_FILE}" "${IND}${IND}return (toUpper(*a) != toUpper(*b) || *a == '\\0') ? (int)toUpper(*a) - (int)toUpper(*b) : compareNoCase(a + 1, b + 1);\n" )
+    file( APPEND "${HPP_FILE}" "${IND}}\n" )
+    file( APPEND "${HPP_FILE}" "${IND}template <typename E> constexpr int compareEntry(std::size_t i, const char* name){\n" )
+    file( APPEND "${HPP_FILE}" "${IND}${IND}return compareNoCase(${T}::entries[i].name + ${T}::rootLength, name);\n" )
+    file( APPEND "${HPP_FILE}" "${IND}}\n" )
+    file( APPEND "${HPP_FILE}" "${IND}template <typename E> constexpr std::size_t findName(const char* name, std::size_t lo, std::size_t hi){\n" )
+    file( APPEND "${HPP_FILE}" "${IND}${IND}return lo >= hi ? ${T}::size\n" )
+    file( APPEND "${HPP_FILE}" "${IND}${IND}${IND}: compareEntry<E>(lo + (hi - lo)/2, name) == 0 ? lo + (hi - lo)/2\n" )
+    file( APPEND "${HPP_FILE}" "${IND}${IND}${IND}: compareEntry<E>(lo + (hi - lo)/2, name) < 0 ? findName<E>(name, lo + (hi - lo)/2 + 1, hi)\n" )
+    file( APPEND "${HPP_FILE}" "${IND}${IND}${IND}: findName<E>(name, lo, lo + (hi - lo)/2);\n" )
+    file( APPEND "${HPP_FILE}" "${IND}}\n" )
+    file( APPEND "${HPP_FILE}" "${IND}template <typename E> constexpr const char* ${OPTS_FUNC_NAME}(E value, std::size_t i){\n" )
+    file( APPEND "${HPP_FILE}" "${IND}${IND}return i >= ${T}::size ? nullptr : ${T}::entries[i].value == value ? ${T}::entries[i].name : ${OPTS_FUNC_NAME}(value, i + 1);\n" )
+    file( APPEND "${HPP_FILE}" "${IND}}\n" )
+    file( APPEND "${HPP_FILE}" "}\n\n" )
+    file( APPEND "${HPP_FILE}" "/// index of the table entry whose name without the common prefix matches the given one (case-insensitive) or 'size' if there is none\n" )
+    file( APPEND "${HPP_FILE}" "template <typename E> constexpr std::size_t findName(const char* name){ return detail::findName<E>(name, 0, ${T}::size); }\n" )
+    file( APPEND "${HPP_FILE}" "/// name of the given enum constant or nullptr if unknown\n" )
+    file( APPEND "${HPP_FILE}" "template <typename E> constexpr const char* ${OPTS_FUNC_NAME}(E value){ return detail::${OPTS_FUNC_NAME}(value, 0); }\n\n" )
+    file( APPEND "${HPP_FILE}" "}\n\n// clang-format on\n" )
+    file( APPEND "${CPP_FILE}" "\n}\n// clang-format on\n" )
   endif( NOT OPTS_USE_CONSTEXPR )
 
 endfunction( enum2str_end )
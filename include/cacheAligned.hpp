@@ -0,0 +1,33 @@
+// cacheAligned.hpp
+#ifndef CADIDAQ_CACHEALIGNED_H
+#define CADIDAQ_CACHEALIGNED_H
+
+#include <new>
+#include <cstddef>
+#include <cstdlib> // posix_memalign, free
+
+namespace cadidaq {
+  /// size of the cache lines that data written by different threads is kept apart by
+  constexpr std::size_t cacheLine = 64;
+  class cacheAligned;
+}
+
+/** /class cacheAligned
+    Base of classes with members aligned to cache lines (alignas(cacheLine)).
+
+    Before C++17, new only guarantees the alignment of the fundamental types
+    and ignores a larger one requested by alignas; objects of derived classes
+    created with new are allocated here on a cache line boundary instead.
+ */
+class cadidaq::cacheAligned {
+public:
+  static void* operator new(std::size_t size){
+    void* p = nullptr;
+    if (posix_memalign(&p, cacheLine, size))
+      throw std::bad_alloc();
+    return p;
+  }
+  static void operator delete(void* p){std::free(p);}
+};
+
+#endif
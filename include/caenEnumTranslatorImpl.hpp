@@ -4,6 +4,9 @@
 #ifndef CADIDAQ_caenEnumTranslator_hpp
 #define CADIDAQ_caenEnumTranslator_hpp
 
+#include <string>
+#include <vector>
+
 #include <boost/property_tree/ptree.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string.hpp>
@@ -11,7 +14,49 @@
 #include <boost/lexical_cast.hpp>
 
 #include <CaenEnum2str.hpp> // generated by CMake in build directory
-#include <helper.hpp>       // helper functions
+
+/** Process-wide lookup of the names of a CAEN enum type, working on the constexpr table generated for it
+    (cadidaq::CaenEnum2str). Names are given without the common enum root ("CAEN_DGTZ_"...), as used in the
+    configuration files. */
+template<typename T>
+class caenEnumTable
+{
+public:
+  typedef cadidaq::CaenEnum2str<T> table;
+
+  static const caenEnumTable& get(){
+    static const caenEnumTable instance;
+    return instance;
+  }
+  /// enum value for the given name (case-insensitive binary search, does not allocate)
+  boost::optional<T> find(const std::string& str) const {
+    std::size_t i = cadidaq::findName<T>(str.c_str());
+    if (i >= table::size)
+      return boost::optional<T>(boost::none);
+    return boost::optional<T>(table::entries[i].value);
+  }
+  /// name of the given enum value (pointing into the static table) or nullptr if unknown
+  const char* name(T value) const {
+    const char* str = cadidaq::toStr(value);
+    if (!str)
+      return nullptr;
+    return str + table::rootLength;
+  }
+  /// all names in alphabetical order
+  const std::vector<std::string>& names() const {
+    // only needed for messages: built on first use (initialization of function-local statics is thread-safe)
+    static const std::vector<std::string> allNames = [](){
+      std::vector<std::string> v;
+      for (std::size_t i = 0; i < table::size; i++)
+        v.push_back(table::entries[i].name + table::rootLength);
+      return v;
+    }();
+    return allNames;
+  }
+
+private:
+  caenEnumTable(){}
+};
 
 /// Custom translator for CAEN enums (only supports std::string as internal type)
 template<typename T>
@@ -23,21 +68,11 @@ struct caenEnumTranslator
     // Converts a (hex)string to int
   boost::optional<external_type> get_value(const internal_type& str){
         if (!str.empty()){
-          external_type value;
-          // get a converter for this CAEN enum type
-          cadidaq::CaenEnum2str enumConverter;
-          auto* map = enumConverter.getBimap(value);
-          // add the leading part of the CAEN enum ("CAEN_DGTZ_"...)
-          std::string searchstr = findEnumRoot(*map) + str;
-
-          // case-insensitive search for string in bimap matching search string
-          typedef typename boost::bimap< std::string, external_type >::left_const_iterator const_iterator;
-          for( const_iterator i = map->left.begin(), iend = map->left.end(); i != iend; ++i ){
-            if(boost::iequals(boost::algorithm::to_lower_copy(i->first), searchstr)){
-              return boost::optional<external_type>(i->second);
-            }
-          }
-          // could not find value in bimap, could be integer value instead
+          // case-insensitive search for the string without the leading part of the CAEN enum ("CAEN_DGTZ_"...)
+          boost::optional<external_type> value = caenEnumTable<external_type>::get().find(str);
+          if (value)
+            return value;
+          // could not find value in the table, could be integer value instead
           try{
             value = static_cast<external_type>( boost::lexical_cast<int>(str) );
           }
@@ -46,7 +81,7 @@ struct caenEnumTranslator
               return boost::optional<external_type>(boost::none);
           }
           // return the converted result
-          return boost::optional<external_type>(value);
+          return value;
         }
         else
           return boost::optional<external_type>(boost::none);
@@ -54,21 +89,12 @@ struct caenEnumTranslator
 
   // Converts a CAEN enum to string
   boost::optional<internal_type> put_value(const external_type& value){
-    // get a converter for this CAEN enum type
-    cadidaq::CaenEnum2str enumConverter;
-    auto* map = enumConverter.getBimap(value);
-    std::string str;
-    // find the string corresponding to the setting's enum value in the bimap
-    try{
-      str = map->right.at(value);
-      // remove the first part originating from CAEN's enum naming convention ("CAEN_DGTZ_".....)
-      str.erase(0,findEnumRoot(*map).length());
-    }
-    catch (std::out_of_range & e){
+    // find the string corresponding to the setting's enum value, already stripped of CAEN's enum naming convention ("CAEN_DGTZ_".....)
+    const char* str = caenEnumTable<external_type>::get().name(value);
+    if (!str)
       // return just the integer should the conversion have failed
       return boost::optional<internal_type>(std::to_string(value));
-    }
-    return boost::optional<internal_type>(str);
+    return boost::optional<internal_type>(internal_type(str));
   }
 };
 
@@ -0,0 +1,269 @@
+// channelVector.hpp
+#ifndef CADIDAQ_CHANNELVECTOR_H
+#define CADIDAQ_CHANNELVECTOR_H
+
+#include <vector>
+#include <bitset>
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/optional.hpp>
+
+#if defined(__BMI2__)
+#include <immintrin.h> // _pext_u64, _pdep_u64
+#endif
+
+namespace cadidaq {
+  template <typename T> class channelVector;
+
+  namespace detail {
+    /// bits of word w of a bit array that correspond to indices in [start, stop)
+    inline uint64_t rangeBits(std::size_t w, std::size_t start, std::size_t stop){
+      const std::size_t lo = w*64, hi = lo + 64;
+      if (stop <= lo || start >= hi)
+        return 0;
+      uint64_t bits = ~uint64_t(0);
+      if (start > lo)
+        bits &= ~uint64_t(0) << (start - lo);
+      if (stop < hi)
+        bits &= ~(~uint64_t(0) << (stop - lo));
+      return bits;
+    }
+
+    inline std::size_t popcount(uint64_t bits){
+      return std::bitset<64>(bits).count();
+    }
+
+    /// index of the lowest bit set (bits must not be 0)
+    inline std::size_t lowestBit(uint64_t bits){
+#if defined(__GNUC__)
+      return __builtin_ctzll(bits);
+#else
+      std::size_t n = 0;
+      while (!(bits & 1)){ bits >>= 1; n++; }
+      return n;
+#endif
+    }
+
+    /// bits 0..n-1 set (n <= 64)
+    inline uint64_t lowBits(std::size_t n){
+      return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+    }
+
+    /// the lowest bit of every group of groupSize bits (groupSize has to divide 64)
+    inline uint64_t groupLeaders(std::size_t groupSize){
+      // e.g. 0xFFFF'FFFF'FFFF'FFFF/0xFF = 0x0101'0101'0101'0101
+      return ~uint64_t(0)/lowBits(groupSize);
+    }
+
+    inline bool isPowerOfTwo(std::size_t n){
+      return n && !(n & (n - 1));
+    }
+
+    /** compresses a channel mask into a group mask: bit g is set if any of the bits
+        [g*groupSize, (g+1)*groupSize) is. Constant time for power-of-two group sizes. */
+    inline uint64_t compressGroups(uint64_t bits, std::size_t groupSize){
+      if (groupSize <= 1)
+        return bits;
+      if (groupSize >= 64)
+        return bits != 0;
+      if (!isPowerOfTwo(groupSize)){
+        uint64_t groups = 0;
+        for (std::size_t g = 0; g*groupSize < 64; g++)
+          groups |= uint64_t((bits >> (g*groupSize) & lowBits(groupSize)) != 0) << g;
+        return groups;
+      }
+      // fold each group onto its lowest bit
+      for (std::size_t s = 1; s < groupSize; s <<= 1)
+        bits |= bits >> s;
+      bits &= groupLeaders(groupSize);
+#if defined(__BMI2__)
+      return _pext_u64(bits, groupLeaders(groupSize));
+#else
+      // pack every groupSize-th bit, halving the distance between them with each pass
+      for (std::size_t stride = groupSize; stride > 1; stride >>= 1){
+        bits = (bits | bits >> 1)  & 0x3333333333333333ull;
+        bits = (bits | bits >> 2)  & 0x0F0F0F0F0F0F0F0Full;
+        bits = (bits | bits >> 4)  & 0x00FF00FF00FF00FFull;
+        bits = (bits | bits >> 8)  & 0x0000FFFF0000FFFFull;
+        bits = (bits | bits >> 16) & 0x00000000FFFFFFFFull;
+      }
+      return bits;
+#endif
+    }
+
+    /** expands a group mask into a channel mask: bits [g*groupSize, (g+1)*groupSize) are set
+        if bit g is. Inverse of compressGroups for masks of whole groups. */
+    inline uint64_t expandGroups(uint64_t groups, std::size_t groupSize){
+      if (groupSize <= 1)
+        return groups;
+      if (groupSize >= 64)
+        return (groups & 1) ? ~uint64_t(0) : 0;
+      groups &= lowBits((64 + groupSize - 1)/groupSize);
+      uint64_t leaders;
+      if (!isPowerOfTwo(groupSize)){
+        leaders = 0;
+        for (std::size_t g = 0; g*groupSize < 64; g++)
+          leaders |= (groups >> g & 1) << (g*groupSize);
+      } else {
+#if defined(__BMI2__)
+        leaders = _pdep_u64(groups, groupLeaders(groupSize));
+#else
+        // spread the bits apart, doubling the distance between them with each pass
+        leaders = groups;
+        for (std::size_t stride = groupSize; stride > 1; stride >>= 1){
+          leaders = (leaders | leaders << 16) & 0x0000FFFF0000FFFFull;
+          leaders = (leaders | leaders << 8)  & 0x00FF00FF00FF00FFull;
+          leaders = (leaders | leaders << 4)  & 0x0F0F0F0F0F0F0F0Full;
+          leaders = (leaders | leaders << 2)  & 0x3333333333333333ull;
+          leaders = (leaders | leaders << 1)  & 0x5555555555555555ull;
+        }
+#endif
+      }
+      // each leader spans its own group, so the product has no carries; the last group might be cut off at bit 63
+      return leaders * lowBits(groupSize);
+    }
+
+    /// dense storage of the values of a channelVector
+    template <typename T>
+    struct channelValues {
+      std::vector<T> v;
+      void resize(std::size_t n){v.resize(n);}
+      T    get(std::size_t i) const {return v[i];}
+      void set(std::size_t i, const T& x){v[i] = x;}
+    };
+
+    /// booleans are packed into words just as the 'set' flags
+    template <>
+    struct channelValues<bool> {
+      std::vector<uint64_t> words;
+      void resize(std::size_t n){words.resize((n + 63)/64);}
+      bool get(std::size_t i) const {return (words[i/64] >> (i%64)) & 1;}
+      void set(std::size_t i, bool x){
+        uint64_t bit = uint64_t(1) << (i%64);
+        words[i/64] = (words[i/64] & ~bit) | (-(uint64_t)x & bit);
+      }
+    };
+  }
+}
+
+/** /class channelVector
+    Per-channel setting values, each of which might be unset.
+
+    Stores a bitmask telling which channels are set next to a dense array of
+    the values (itself a bitmask for booleans) instead of one
+    boost::optional per channel: counting, testing for uniformity or turning
+    the setting into a channel mask work on whole words, and a 64-channel
+    setting takes a few cache lines. Values of unset channels are kept at T().
+    Elements are read as boost::optional<T> by value; they are modified
+    through set(), reset() and assign().
+ */
+template <typename T>
+class cadidaq::channelVector {
+public:
+  static const std::size_t all = std::numeric_limits<std::size_t>::max();
+
+  channelVector(std::size_t n = 0) : n(n), setWords((n + 63)/64, 0) {values.resize(n);}
+
+  std::size_t size() const {return n;}
+
+  bool isSet(std::size_t i) const {return (setWords[i/64] >> (i%64)) & 1;}
+  /// value of a channel; T() if unset
+  T    value(std::size_t i) const {return values.get(i);}
+  boost::optional<T> operator[](std::size_t i) const {
+    return isSet(i) ? boost::optional<T>(values.get(i)) : boost::optional<T>();
+  }
+
+  void set(std::size_t i, const T& x){
+    setWords[i/64] |= uint64_t(1) << (i%64);
+    values.set(i, x);
+  }
+  void reset(std::size_t i){
+    setWords[i/64] &= ~(uint64_t(1) << (i%64));
+    values.set(i, T());
+  }
+  void assign(std::size_t i, const boost::optional<T>& x){
+    if (x) set(i, *x); else reset(i);
+  }
+  /// sets the channels selected in mask (one bit per channel, words() words) to x
+  void set(const uint64_t* mask, const T& x){
+    for (std::size_t w = 0; w < setWords.size(); w++){
+      setWords[w] |= mask[w];
+      for (uint64_t bits = mask[w]; bits; bits &= bits - 1)
+        values.set(w*64 + detail::lowestBit(bits), x);
+    }
+  }
+  /// sets (or unsets) all channels
+  void fill(const boost::optional<T>& x){
+    for (std::size_t i = 0; i < n; i++)
+      assign(i, x);
+  }
+
+  /// word w of the mask of set channels (bit i%64 of word i/64 for channel i)
+  uint64_t setBits(std::size_t w) const {return setWords[w];}
+  std::size_t words() const {return setWords.size();}
+
+  /// number of channels set within [start, stop)
+  std::size_t countSet(std::size_t start = 0, std::size_t stop = all) const {
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < setWords.size(); w++)
+      count += detail::popcount(setWords[w] & detail::rangeBits(w, start, stop));
+    return count;
+  }
+
+  /// index of the first channel set within [start, stop) or size() if there is none
+  std::size_t firstSet(std::size_t start = 0, std::size_t stop = all) const {
+    for (std::size_t w = 0; w < setWords.size(); w++){
+      uint64_t bits = setWords[w] & detail::rangeBits(w, start, stop);
+      if (bits)
+        return w*64 + detail::lowestBit(bits);
+    }
+    return n;
+  }
+
+  /// whether all set channels within [start, stop) hold the same value
+  bool allSame(std::size_t start = 0, std::size_t stop = all) const {
+    std::size_t first = firstSet(start, stop);
+    if (first >= n)
+      return true;
+    const T v = values.get(first);
+    for (std::size_t w = 0; w < setWords.size(); w++){
+      uint64_t set = setWords[w] & detail::rangeBits(w, start, stop);
+      if (set && (set & ~equalBits(w, v, values)))
+        return false;
+    }
+    return true;
+  }
+
+  /// word w of the mask of set channels holding the value x
+  uint64_t matchingBits(std::size_t w, const T& x) const {return setWords[w] & equalBits(w, x, values);}
+
+  /// word w of the mask of channels set to 'true' (booleans only)
+  uint64_t trueBits(std::size_t w) const {return setWords[w] & values.words[w];}
+  /// sets all channels of word w to the given bits (booleans only)
+  void assignBits(std::size_t w, uint64_t bits){
+    setWords[w] = detail::rangeBits(w, 0, n);
+    values.words[w] = bits & setWords[w];
+  }
+
+private:
+  // word w of the mask of channels (set or not) whose value equals v, without branching on the individual channels
+  template <typename V>
+  uint64_t equalBits(std::size_t w, const T& v, const V&) const {
+    uint64_t equal = 0;
+    for (std::size_t i = w*64, last = std::min(i + 64, n); i < last; i++)
+      equal |= uint64_t(values.v[i] == v) << (i%64);
+    return equal;
+  }
+  uint64_t equalBits(std::size_t w, bool v, const detail::channelValues<bool>&) const {
+    return v ? values.words[w] : ~values.words[w];
+  }
+
+  std::size_t                n;
+  std::vector<uint64_t>      setWords;
+  detail::channelValues<T>   values;
+};
+
+#endif
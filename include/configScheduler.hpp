@@ -0,0 +1,48 @@
+// configScheduler.hpp
+#ifndef CADIDAQ_CONFIGSCHEDULER_H
+#define CADIDAQ_CONFIGSCHEDULER_H
+
+#include <vector>
+#include <exception>
+
+#include <boost/log/trivial.hpp>
+#include <boost/log/sources/severity_channel_logger.hpp>
+
+#include <boost/property_tree/ptree.hpp>
+
+namespace pt = boost::property_tree;
+
+namespace cadidaq {
+  class digitizer;
+  class configScheduler;
+}
+
+/** /class configScheduler
+    Opens and programs a set of digitizers, either one after another or all concurrently with one thread per board.
+    Reports the wall time spent on each board and in total. Failures of a board, including exceptions thrown while
+    configuring it, are collected in its worker and only reported (and acted upon) by the caller's thread once all
+    boards are done.
+ */
+class cadidaq::configScheduler {
+public:
+  configScheduler();
+  /// queues the digitizer to be configured with the settings in node
+  void add(cadidaq::digitizer* digi, pt::iptree* node);
+  /// configures all queued digitizers and returns once all of them are done; returns false if any of them failed
+  bool run(bool parallel);
+
+private:
+  struct job {
+    cadidaq::digitizer* digi;
+    pt::iptree*         node;
+    double              seconds;
+    bool                connected;
+    std::exception_ptr  error;     ///< thrown while configuring the board
+  };
+  static void configure(job* j);
+
+  std::vector<job> jobs;
+  boost::log::sources::severity_channel_logger< boost::log::trivial::severity_level, std::string > lg;
+};
+
+#endif
@@ -3,6 +3,8 @@
 #define CADIDAQ_DIGITIZER_H
 
 #include <string>
+#include <vector>
+#include <type_traits>
 
 #include <boost/log/trivial.hpp>
 #include <boost/log/sources/severity_channel_logger.hpp>
@@ -14,43 +16,130 @@
 
 namespace caen {
   class Digitizer;
+  class Error;
 }
 
 namespace cadidaq {
 
+  struct readoutBuffer;
+
+  /** /struct boardInfo
+      Static properties of a digitizer, read once after opening the device. Each query through caen::Digitizer is a
+      library call (and round-trip to the board), so all code paths use this snapshot instead; as it is never modified
+      after connecting, readout threads can use it without locking. */
+  struct boardInfo {
+    std::string model;
+    uint32_t    modelNo;
+    uint32_t    serial;
+    uint32_t    channels;
+    uint32_t    groups;
+    uint32_t    channelsPerGroup;
+    uint32_t    adcBits;
+    bool        hasDppFw;
+    bool        isDppCiFw;
+    bool        is751Family;
+    std::string license;
+    uint32_t    formFactor;
+    uint32_t    familyCode;
+    std::string rocFirmware;
+    std::string amcFirmware;
+    uint32_t    pcbRevision;
+    uint32_t    tickPeriod;   ///< ns per tick of the trigger time tags
+  };
+
   class digitizer {
   public:
     digitizer(std::string name);
     ~digitizer();
-    void             configure(pt::iptree *node);
+    /// connects to the device and programs it; if already connected, only programs settings differing from the device state;
+    /// returns false if the device could not be opened
+    bool             configure(pt::iptree *node);
     pt::iptree*      retrieveConfig();
     caen::Digitizer* getDevice(){return dg;}
+    /// static properties of the connected device (only valid once connected)
+    const boardInfo& getBoardInfo(){return info;}
+    /// settings as last programmed into or read back from the device
+    const registerSettings& getRegisterSettings(){return *reg;}
     std::string      getName(){return name;}
+    /// number of device writes issued and skipped as the value was known to be on the device already
+    uint64_t         getWrites(){return nWrites;}
+    uint64_t         getElidedWrites(){return nElidedWrites;}
+    /// number of raw register writes left out as they repeated the write just before
+    uint64_t         getMergedWrites(){return nMergedWrites;}
+    /// number of failed device calls while programming or reading back settings
+    uint64_t         getErrors(){return nErrors;}
+
+    /// acquisition control and block transfer readout
+    bool             startAcquisition();
+    void             stopAcquisition();
+    bool             allocateBuffer(readoutBuffer& buffer);
+    void             freeBuffer(readoutBuffer& buffer);
+    bool             readData(readoutBuffer& buffer);
   private:
     enum class comDirection {READING, WRITING};
 
+    /// failed device calls of one kind (same call and message), collected during a pass over the settings
+    struct deviceError {
+      std::string call;
+      std::string message;
+      std::string firstContext; ///< arguments of the first failed call
+      uint64_t    count;
+    };
+    template <typename F>
+    void recordError(const caen::Error& e, F context);
+    void reportErrors(comDirection direction);
+
     void verifySettings();
 
     template <typename T>
-    void programWrapper(void (caen::Digitizer::*write)(T), T (caen::Digitizer::*read)(), boost::optional<T> &value, comDirection direction);
+    void programWrapper(void (caen::Digitizer::*write)(T), T (caen::Digitizer::*read)(), boost::optional<T> &value, boost::optional<T> &known, comDirection direction);
 
     template <typename T, typename C>
-    void programWrapper(void (caen::Digitizer::*write)(C, T), T (caen::Digitizer::*read)(C), C channel, boost::optional<T> &value, comDirection direction);
+    void programWrapper(void (caen::Digitizer::*write)(C, T), T (caen::Digitizer::*read)(C), C channel, boost::optional<T> &value, boost::optional<T> &known, comDirection direction);
 
     template <typename T1, typename T2>
-    void programWrapper(void (caen::Digitizer::*write)(T1, T2), void (caen::Digitizer::*read)(T1&, T2&), boost::optional<T1> &value1, boost::optional<T2> &value2, comDirection direction);
+    void programWrapper(void (caen::Digitizer::*write)(T1, T2), void (caen::Digitizer::*read)(T1&, T2&), boost::optional<T1> &value1, boost::optional<T2> &value2, boost::optional<T1> &known1, boost::optional<T2> &known2, comDirection direction);
 
-    void programMaskWrapper(void (caen::Digitizer::*write)(uint32_t), uint32_t (caen::Digitizer::*read)(), cadidaq::settingsBase::optionVector<bool> &vec, comDirection direction);
+    void programMaskWrapper(void (caen::Digitizer::*write)(uint32_t), uint32_t (caen::Digitizer::*read)(), cadidaq::settingsBase::optionVector<bool> &vec, cadidaq::settingsBase::optionVector<bool> &known, comDirection direction);
 
     template <typename T, typename C>
-    void programLoopWrapper(void (caen::Digitizer::*write)(C, T), T (caen::Digitizer::*read)(C), cadidaq::settingsBase::optionVector<T> &vec, comDirection direction, bool ignoreGroups);
-
+    void programLoopWrapper(void (caen::Digitizer::*write)(C, T), T (caen::Digitizer::*read)(C), cadidaq::settingsBase::optionVector<T> &vec, cadidaq::settingsBase::optionVector<T> &known, comDirection direction, bool ignoreGroups = false);
+
+    /// dispatch of the rows of CADIDAQ_REGISTER_SETTINGS to the wrappers above according to their settingAccess
+    template <cadidaq::settingAccess A>
+    using accessTag = std::integral_constant<cadidaq::settingAccess, A>;
+    bool inScope(cadidaq::settingScope scope);
+    template <typename S, typename WC, typename RC, typename WG, typename RG>
+    void programTableSetting(accessTag<cadidaq::settingAccess::COMMON>, WC writeChannel, RC readChannel, WG, RG, S &setting, S &known, comDirection direction);
+    template <typename S, typename WC, typename RC, typename WG, typename RG>
+    void programTableSetting(accessTag<cadidaq::settingAccess::CHANNELS>, WC writeChannel, RC readChannel, WG writeGroup, RG readGroup, S &setting, S &known, comDirection direction);
+    template <typename S, typename WC, typename RC, typename WG, typename RG>
+    void programTableSetting(accessTag<cadidaq::settingAccess::EACH_CHANNEL>, WC writeChannel, RC readChannel, WG, RG, S &setting, S &known, comDirection direction);
+    template <typename S, typename WC, typename RC, typename WG, typename RG>
+    void programTableSetting(accessTag<cadidaq::settingAccess::MASK>, WC writeChannel, RC readChannel, WG writeGroup, RG readGroup, S &setting, S &known, comDirection direction);
+    template <typename S, typename WC, typename RC, typename WG, typename RG>
+    void programTableSetting(accessTag<cadidaq::settingAccess::CUSTOM>, WC, RC, WG, RG, S &setting, S &, comDirection direction){programCustomSetting(&setting, direction);}
+    void programCustomSetting(const void* setting, comDirection direction);
+
+    void forgetDeviceState();
+    void forgetDependentSettings(const void* setting);
+    void programRegisters(comDirection direction, bool rewrite);
+    void programRegisterSettings(pt::iptree *node);
     void programSettings(comDirection direction);
 
     caen::Digitizer*    dg;
     connectionSettings* lnk;
     registerSettings*   reg;
+    /// shadow copy of the last known device state (from previous reads or writes); unset values are unknown
+    registerSettings*   shadow;
+    uint64_t            nWrites;
+    uint64_t            nElidedWrites;
+    uint64_t            nMergedWrites;
+    uint64_t            nErrors;
+    std::vector<deviceError> errors;
+    uint64_t            nUnlistedErrors;
     std::string         name;
+    boardInfo           info;
     boost::log::sources::severity_channel_logger< boost::log::trivial::severity_level, std::string > lg;
   };
 }
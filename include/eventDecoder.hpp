@@ -0,0 +1,340 @@
+// eventDecoder.hpp
+#ifndef CADIDAQ_EVENTDECODER_H
+#define CADIDAQ_EVENTDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include <CAENDigitizerType.h>
+
+#include <channelVector.hpp> // detail::popcount
+#include <timestampExtender.hpp>
+
+namespace cadidaq {
+  struct boardInfo;
+  class registerSettings;
+
+  enum class sampleLayout : uint8_t;
+  struct channelData;
+  struct eventView;
+  class standardDecoder;
+  struct dppHit;
+  class dppDecoder;
+}
+
+/// packing of the samples in the data words of the standard firmware
+enum class cadidaq::sampleLayout : uint8_t {
+  PAIRS,    ///< two samples per word in bits [13:0] and [29:16] (x720, x724, x725, x730)
+  TRIPLETS, ///< three 10-bit samples per word in bits [9:0], [19:10] and [29:20] (x751)
+  GROUP_12  ///< groups of 8 channels, 3 samples of each channel in 9 words as a stream of 12-bit values (x740)
+};
+
+/** /struct channelData
+    Zero-copy view of the samples of one channel inside an event in the readout buffer.
+ */
+struct cadidaq::channelData {
+  const uint32_t* words;      ///< data block of the channel (of its group for GROUP_12)
+  uint32_t        nSamples;   ///< 0 if the channel is not part of the event
+  uint32_t        channel;    ///< index of the channel on the board
+  uint16_t        sampleMask; ///< ADC bits
+  sampleLayout    layout;
+  uint8_t         subChannel; ///< index of the channel within its group (GROUP_12)
+
+  uint16_t sample(uint32_t i) const {
+    switch (layout){
+    case sampleLayout::PAIRS:
+      return (words[i/2] >> (16*(i%2))) & sampleMask;
+    case sampleLayout::TRIPLETS:
+      return (words[i/3] >> (10*(i%3))) & sampleMask;
+    case sampleLayout::GROUP_12:
+    default: {
+      // 12-bit value number (block, channel, sample in block) of the group's bit stream
+      uint32_t bit = ((i/3)*24 + subChannel*3 + i%3)*12;
+      uint32_t shift = bit%32;
+      uint64_t pair = words[bit/32] | (shift > 20 ? (uint64_t)words[bit/32 + 1] << 32 : 0);
+      return (pair >> shift) & sampleMask;
+    }
+    }
+  }
+
+  /// copies all samples to out (room for nSamples values) with the fastest kernel of sampleUnpack.hpp the CPU supports;
+  /// sampleBuffer provides an aligned and padded array
+  void unpack(uint16_t* out) const;
+};
+
+/** /struct eventView
+    Zero-copy view of one event of a standard-firmware block transfer; only valid as long as the buffer is.
+ */
+struct cadidaq::eventView {
+  const uint32_t* words;            ///< the event's words, starting with its 4-word header
+  uint64_t        time;             ///< trigger time tag extended across rollovers (ticks of boardInfo::tickPeriod)
+  uint32_t        blockWords;       ///< words of data per channel (per group of channels for GROUP_12)
+  uint32_t        samplesPerBlock;  ///< samples per channel
+  uint16_t        sampleMask;
+  uint8_t         channelsPerBlock;
+  sampleLayout    layout;
+
+  uint32_t size() const          {return words[0] & 0x0FFFFFFF;}
+  uint32_t boardId() const       {return words[1] >> 27;}
+  bool     boardFail() const     {return (words[1] >> 26) & 1;}
+  uint32_t pattern() const       {return (words[1] >> 8) & 0xFFFF;}
+  /// channels (groups for grouped boards) in the event; bits [15:8] only on 16-channel boards
+  uint32_t channelMask() const   {return (words[1] & 0xFF) | ((words[2] >> 16) & 0xFF00);}
+  uint32_t eventCounter() const  {return words[2] & 0xFFFFFF;}
+  uint32_t triggerTimeTag() const{return words[3];}
+
+  /// samples of a channel of the board (nSamples 0 if the channel is not part of the event)
+  cadidaq::channelData channel(uint32_t ch) const {
+    uint32_t block = ch/channelsPerBlock;
+    uint32_t mask = channelMask();
+    channelData d = {words + 4, 0, ch, sampleMask, layout, (uint8_t)(ch%channelsPerBlock)};
+    if (block < 16 && ((mask >> block) & 1)){
+      // blocks of the enabled channels follow each other in the order of the channels
+      d.words += blockWords*detail::popcount(mask & ((1u << block) - 1));
+      d.nSamples = samplesPerBlock;
+    }
+    return d;
+  }
+};
+
+/** /class standardDecoder
+    Walks the events in the block transfers of a board running the standard firmware.
+
+    Events are handed out as eventViews pointing into the readout buffer; nothing is copied or allocated, and
+    samples are only unpacked when asked for. The header of each event tells its size and the channels it holds;
+    the channel mask and record length configured on the board are only used to tell events with an unexpected
+    layout, which are counted but still decoded. A buffer is abandoned at the first corrupt header.
+ */
+class cadidaq::standardDecoder {
+public:
+  /// layout of the events of the given board for the configured channel mask (groups for grouped boards) and record length
+  standardDecoder(const cadidaq::boardInfo& info, uint32_t channelMask, uint32_t recordLength);
+  /// same with mask and record length taken from the board's settings (not checked if they are unknown)
+  standardDecoder(const cadidaq::boardInfo& info, const cadidaq::registerSettings& settings);
+
+  /// calls onEvent(const eventView&) for each event in the buffer; returns the number of events
+  template <typename F>
+  uint32_t decode(const char* data, uint32_t size, F onEvent){
+    const uint32_t* w = reinterpret_cast<const uint32_t*>(data);
+    const uint32_t* end = w + size/sizeof(uint32_t);
+    eventView ev = {nullptr, 0, 0, 0, sampleMask, channelsPerBlock, layout};
+    // local copy, which the compiler can keep in registers across the calls of onEvent
+    timestampExtender extender = clock;
+    uint32_t n = 0;
+    while (w + 4 <= end){
+      uint32_t eventWords = w[0] & 0x0FFFFFFF;
+      uint32_t mask = (w[1] & 0xFF) | ((w[2] >> 16) & 0xFF00);
+      uint32_t nBlocks = detail::popcount(mask);
+      if ((w[0] >> 28) != 0xA || eventWords < 4 || eventWords > (uint32_t)(end - w)
+          || (nBlocks ? (eventWords - 4) % nBlocks : eventWords - 4) != 0){
+        nCorrupt++;
+        break;
+      }
+      ev.words = w;
+      ev.time = extender.extend(w[3]);
+      ev.blockWords = nBlocks ? (eventWords - 4)/nBlocks : 0;
+      ev.samplesPerBlock = samplesFor(ev.blockWords);
+      if (checkLayout && (mask != expectedMask || (nBlocks && ev.blockWords != expectedBlockWords)))
+        nUnexpected++;
+      onEvent(static_cast<const eventView&>(ev));
+      w += eventWords;
+      n++;
+    }
+    clock = extender;
+    nEvents += n;
+    return n;
+  }
+
+  uint64_t getEvents() const            {return nEvents;}
+  /// buffers abandoned at a corrupt event header
+  uint64_t getCorruptBuffers() const    {return nCorrupt;}
+  /// events whose channels or size differ from what was configured
+  uint64_t getUnexpectedEvents() const  {return nUnexpected;}
+  sampleLayout getLayout() const        {return layout;}
+  /// rollovers and order of the trigger time tags
+  const cadidaq::timestampExtender& getClock() const {return clock;}
+
+private:
+  uint32_t samplesFor(uint32_t blockWords) const {
+    switch (layout){
+    case sampleLayout::PAIRS:    return blockWords*2;
+    case sampleLayout::TRIPLETS: return blockWords*3;
+    default:                     return blockWords/9*3;
+    }
+  }
+
+  sampleLayout layout;
+  uint16_t     sampleMask;
+  uint8_t      channelsPerBlock;
+  bool         checkLayout;
+  uint32_t     expectedMask;
+  uint32_t     expectedBlockWords;
+  cadidaq::timestampExtender clock;
+  uint64_t     nEvents;
+  uint64_t     nCorrupt;
+  uint64_t     nUnexpected;
+};
+
+/** /struct dppHit
+    Fixed-size record of one hit decoded from the channel aggregates of a DPP-PSD or DPP-PHA firmware.
+    Fields not delivered by the firmware or not requested through the DPP save parameter are 0, see flags.
+ */
+struct cadidaq::dppHit {
+  enum flag : uint16_t {
+    TIME   = 1 << 0, ///< timeTag valid
+    ENERGY = 1 << 1, ///< energy (and chargeLong for DPP-PSD) valid
+    PILEUP = 1 << 2  ///< pile-up or saturation flagged with the energy
+    // bits [15:10]: flags of the firmware's extras word
+  };
+
+  uint64_t timeTag;    ///< trigger time tag (with the bits of the extras word if present) extended across rollovers
+  uint32_t waveform;   ///< offset (in 32-bit words) of the waveform in the decoded buffer, see dppDecoder::waveform()
+  uint16_t nSamples;   ///< 0 if the hit comes without waveform
+  uint16_t energy;     ///< energy (DPP-PHA) or charge of the short gate (DPP-PSD)
+  uint16_t chargeLong; ///< charge of the long gate (DPP-PSD)
+  uint16_t fineTime;   ///< fine time stamp of the extras word
+  uint16_t flags;
+  uint8_t  channel;
+  uint8_t  boardId;
+};
+
+static_assert(sizeof(cadidaq::dppHit) == 24, "DPP hits have to be 24 bytes");
+
+/** /class dppDecoder
+    Walks the board aggregates in the block transfers of a board running the DPP-PSD or DPP-PHA firmware.
+
+    Each board aggregate holds one channel aggregate per enabled channel (per pair of channels for the x725/x730
+    firmwares), whose format word tells which fields each of its hits carries: trigger time tag, waveform, extras
+    word and energy/charge word. Hits are handed out as dppHits filled in place, without allocating; waveforms stay
+    in the readout buffer. The configured save parameter selects which of time and energy are reported, and together
+    with the acquisition mode (waveforms unless in list mode) tells hits with an unexpected format, which are counted
+    but still decoded. A buffer is abandoned at the first corrupt aggregate header.
+ */
+class cadidaq::dppDecoder {
+public:
+  /// whether the board runs a DPP firmware whose aggregates can be decoded
+  static bool supports(const cadidaq::boardInfo& info);
+
+  dppDecoder(const cadidaq::boardInfo& info, CAEN_DGTZ_DPP_SaveParam_t saveParam, CAEN_DGTZ_DPP_AcqMode_t acqMode);
+  /// same with save parameter and acquisition mode taken from the board's settings (not checked if they are unknown)
+  dppDecoder(const cadidaq::boardInfo& info, const cadidaq::registerSettings& settings);
+
+  /// calls onHit(const dppHit&) for each hit in the buffer; returns the number of hits
+  template <typename F>
+  uint32_t decode(const char* data, uint32_t size, F onHit){
+    const uint32_t* begin = reinterpret_cast<const uint32_t*>(data);
+    const uint32_t* end = begin + size/sizeof(uint32_t);
+    // local copy, which the compiler can keep in registers across the calls of onHit
+    timestampExtender extender = clock;
+    uint32_t n = 0;
+    for (const uint32_t* w = begin; w + 4 <= end;){
+      uint32_t aggregateWords = w[0] & 0x0FFFFFFF;
+      if ((w[0] >> 28) != 0xA || aggregateWords < 4 || aggregateWords > (uint32_t)(end - w)){
+        nCorrupt++;
+        break;
+      }
+      const uint32_t* aggregateEnd = w + aggregateWords;
+      const uint32_t* c = w + 4;
+      uint8_t boardId = w[1] >> 27;
+      // one channel aggregate per bit of the mask, in the order of the channels
+      uint32_t bits = w[1] & 0xFF;
+      for (; bits; bits &= bits - 1){
+        if (aggregateEnd - c < 2 || !(c[0] >> 31))
+          break;
+        uint32_t channelWords = c[0] & 0x3FFFFF;
+        if (channelWords < 2 || channelWords > (uint32_t)(aggregateEnd - c))
+          break;
+        uint32_t format = c[1];
+        bool hasTime = (format >> 29) & 1, hasEnergy = (format >> 30) & 1, hasExtras = (format >> 28) & 1;
+        uint32_t nSamples = ((format >> 27) & 1) ? (format & 0xFFFF)*8 : 0;
+        uint32_t hitWords = hasTime + nSamples/2 + hasExtras + hasEnergy;
+        // more samples than dppHit::nSamples holds are beyond any record length the firmware supports
+        if (hitWords == 0 || (channelWords - 2) % hitWords != 0 || nSamples > std::numeric_limits<uint16_t>::max())
+          break;
+        if (checkFormat && (format & formatBits) != expectedFormat)
+          nUnexpected += (channelWords - 2)/hitWords;
+        // the extras word widens the counter of the time tags
+        uint32_t timeBits = hasExtras ? 47 : 31;
+        extender.setBits(timeBits);
+        uint8_t firstChannel = detail::lowestBit(bits)*channelsPerAggregate;
+        for (const uint32_t* h = c + 2; h != c + channelWords; h += hitWords){
+          const uint32_t* p = h;
+          dppHit hit = {};
+          hit.boardId = boardId;
+          hit.channel = firstChannel;
+          if (hasTime){
+            // the odd channel of a pair is flagged in the time tag word
+            if (channelsPerAggregate > 1)
+              hit.channel += *p >> 31;
+            hit.timeTag = *p++ & 0x7FFFFFFF;
+          }
+          if (nSamples){
+            hit.waveform = p - begin;
+            hit.nSamples = nSamples;
+            p += nSamples/2;
+          }
+          if (hasExtras){
+            hit.timeTag |= (uint64_t)(*p >> 16) << 31;
+            hit.fineTime = *p & 0x3FF;
+            hit.flags = *p & 0xFC00;
+            p++;
+          }
+          if (reportTime && hasTime){
+            hit.timeTag = extender.extend(hit.timeTag);
+            hit.flags |= dppHit::TIME;
+          } else
+            hit.timeTag = 0;
+          if (reportEnergy && hasEnergy){
+            hit.energy = *p & 0x7FFF;
+            hit.chargeLong = isPsd ? *p >> 16 : 0;
+            hit.flags |= dppHit::ENERGY | (((*p >> 15) & 1) ? dppHit::PILEUP : 0);
+          }
+          onHit(static_cast<const dppHit&>(hit));
+          n++;
+        }
+        c += channelWords;
+      }
+      if (bits || c != aggregateEnd){
+        nCorrupt++;
+        break;
+      }
+      w = aggregateEnd;
+    }
+    clock = extender;
+    nHits += n;
+    return n;
+  }
+
+  /// samples of the waveform of a hit decoded from the given buffer (only valid as long as the buffer is)
+  cadidaq::channelData waveform(const char* data, const dppHit& hit) const {
+    channelData d = {reinterpret_cast<const uint32_t*>(data) + hit.waveform, hit.nSamples, hit.channel, sampleMask, sampleLayout::PAIRS, 0};
+    return d;
+  }
+
+  uint64_t getHits() const              {return nHits;}
+  /// buffers abandoned at a corrupt aggregate header
+  uint64_t getCorruptBuffers() const    {return nCorrupt;}
+  /// hits whose fields differ from what was configured
+  uint64_t getUnexpectedHits() const    {return nUnexpected;}
+  /// rollovers and order of the time tags (hits of different channels are late within an aggregate)
+  const cadidaq::timestampExtender& getClock() const {return clock;}
+
+private:
+  /// bits of the channel aggregate format word compared against the configuration: energy, time tag and samples enabled
+  static const uint32_t formatBits = (1u << 30) | (1u << 29) | (1u << 27);
+
+  bool     isPsd;
+  uint8_t  channelsPerAggregate;
+  uint16_t sampleMask;
+  bool     reportTime;
+  bool     reportEnergy;
+  bool     checkFormat;
+  uint32_t expectedFormat;
+  cadidaq::timestampExtender clock;
+  uint64_t nHits;
+  uint64_t nCorrupt;
+  uint64_t nUnexpected;
+};
+
+#endif
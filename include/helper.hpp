@@ -2,200 +2,292 @@
 #define CADIDAQ_HELPER_H
 
 #include <bitset>
-#include <iterator>  // distance
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+#include <iterator>  // next
 
 #include <boost/optional.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp> // boost::starts_with
 
+#include <channelVector.hpp>
 
-/** converts a vector of optional<bool> into a uint32 bit mask.
+
+/** converts a vector of optional<bool> into a bit mask (of up to 64 channels or groups).
     defaults to bit=0 if corresponding optional not set.
-    groups parameter allows to group the bits with any bit in the group being 1 leading to the resulting group's bit being 1
-    blocksize parameter allows to switch bits in blocks of the given number of bits.
+    groupSize parameter allows to group the channels with any channel in the group being 'true' leading to the resulting group's bit being 1
 */
-inline uint32_t vec2Mask(std::vector<boost::optional<bool>>& vec, uint ngroups, uint blocksize = 1){
-  std::bitset<32> mask(0);
-  for (auto it = vec.begin(); it != vec.end(); ++it) {
-    auto index = std::distance(vec.begin(), it);
-    // set value if set and 'true' (else it stays 0)
-    if (*it && **it) {
-      // create a bit pattern for the channel/group the channel belongs to with size of blocksize
-      uint32_t shift = (((uint32_t)1 << blocksize) - 1) << index/(ngroups*blocksize);
-      // set that pattern (applied multiple times if groupsize>1 and remains 'true' if one of the group's members was)
-      mask |= shift;
+inline uint64_t vec2Mask(const cadidaq::channelVector<bool>& vec, uint groupSize = 1){
+  groupSize = std::max(groupSize, 1u);
+  uint64_t mask = 0;
+  if (vec.words() > 1 && 64 % groupSize){
+    // groups straddle the words of the vector: visit the channels set to 'true' one by one
+    for (std::size_t w = 0; w < vec.words(); w++){
+      for (uint64_t bits = vec.trueBits(w); bits; bits &= bits - 1){
+        std::size_t group = (w*64 + cadidaq::detail::lowestBit(bits))/groupSize;
+        if (group < 64)
+          mask |= uint64_t(1) << group;
+      }
     }
+    return mask;
   }
-  return mask.to_ulong();
+  // each word of 64 channels maps to 64/groupSize bits of the mask
+  for (std::size_t w = 0; w < vec.words() && w*64/groupSize < 64; w++)
+    mask |= cadidaq::detail::compressGroups(vec.trueBits(w), groupSize) << (w*64/groupSize);
+  return mask;
+}
+
+/// expands a group mask into the corresponding channel mask (all channels of a group set if the group's bit is)
+inline uint64_t expandMask(uint64_t mask, uint groupSize){
+  return cadidaq::detail::expandGroups(mask, std::max(groupSize, 1u));
 }
 
-/// fills the given bit mask into a vector of boost::optional<bool>
-inline  void mask2Vec(boost::optional<uint32_t> mask, std::vector<boost::optional<bool>>& vec, uint ngroups = 1){
+/// fills the given bit mask (of channels or groups of groupSize channels) into a vector of boost::optional<bool>
+inline void mask2Vec(boost::optional<uint64_t> mask, cadidaq::channelVector<bool>& vec, uint groupSize = 1){
   if (!mask){
     // invalid argument -> set vector elements to boost::none
-    for (auto it = vec.begin(); it != vec.end(); ++it)
-      *it = boost::none;
+    vec.fill(boost::none);
+    return;
+  }
+  groupSize = std::max(groupSize, 1u);
+  if (vec.words() > 1 && 64 % groupSize){
+    // groups straddle the words of the vector: assign the channels one by one
+    for (std::size_t index = 0; index < vec.size(); index++){
+      std::size_t group = index/groupSize;
+      vec.set(index, group < 64 && ((*mask >> group) & 1));
+    }
     return;
   }
-  std::bitset<32> bits(*mask);
-  for (auto it = vec.begin(); it != vec.end(); ++it) {
-    auto index = std::distance(vec.begin(), it);
-    uint group = index/ngroups;
-    // set vector entry
-    *it = bits[group];
+  for (std::size_t w = 0; w < vec.words(); w++){
+    std::size_t firstGroup = w*64/groupSize;
+    vec.assignBits(w, firstGroup < 64 ? expandMask(*mask >> firstGroup, groupSize) : 0);
   }
 }
 
 /// counts the number of 'true' values in a vector of boost::optional<bool> (optionally limited to an index range startidx--stopidx)
-inline int countTrue(std::vector<boost::optional<bool>>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
+inline int countTrue(const cadidaq::channelVector<bool>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
   int nTrue = 0;
-  for (auto it = vec.begin(); it != vec.end(); ++it) {
-    auto index = std::distance(vec.begin(), it);
-    if (index >= startidx && index < stopidx && *it && **it) {
-      nTrue++;
-    }
-  }
+  for (std::size_t w = 0; w < vec.words(); w++)
+    nTrue += cadidaq::detail::popcount(vec.trueBits(w) & cadidaq::detail::rangeBits(w, startidx, stopidx));
   return nTrue;
 }
 
 /// counts the number of set values in a vector of boost::optional<bool> (optionally limited to an index range startidx--stopidx)
 template <typename T>
-inline int countSet(std::vector<boost::optional<T>>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
-  int nSet = 0;
-  for (auto it = vec.begin(); it != vec.end(); ++it) {
-    auto index = std::distance(vec.begin(), it);
-    if (index >= startidx && index < stopidx && *it) {
-      nSet++;
-    }
-  }
-  return nSet;
+inline int countSet(const cadidaq::channelVector<T>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
+  return vec.countSet(startidx, stopidx);
 }
 
 /// returns the first set value in a range of indexes in a vector of boost::optional _or_ returns a boost::optional set to boost::none if no element is set
 template <typename T>
-inline boost::optional<T> getFirstSetValue(std::vector<boost::optional<T>>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
-  // find first defined value in the idx range
-  for (auto it = vec.begin(); it != vec.end(); ++it) {
-    auto index = std::distance(vec.begin(), it);
-    if (index >= startidx && index < stopidx && (*it)){
-      return *it;
-    }
-  }
-  return boost::optional<T>(boost::none);
+inline boost::optional<T> getFirstSetValue(const cadidaq::channelVector<T>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
+  std::size_t first = vec.firstSet(startidx, stopidx);
+  if (first >= vec.size())
+    return boost::optional<T>(boost::none);
+  return vec[first];
 }
 
 /// tests if all values in a vector of boost::optional are set to some identical value _or_ all are undefined (optionally limited to an index range startidx--stopidx)
 template <typename T>
-inline bool allValuesSame(std::vector<boost::optional<T>>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
-  // get value of first defined element
-  boost::optional<T> value = getFirstSetValue(vec, startidx, stopidx);
-  // compare against all values
-  for (auto it = vec.begin(); it != vec.end(); ++it) {
-    auto index = std::distance(vec.begin(), it);
-    if (index >= startidx && index < stopidx && *it && (*it != value))
-      return false;
-  }
-  return true;
+inline bool allValuesSame(const cadidaq::channelVector<T>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
+  return vec.allSame(startidx, stopidx);
 }
 
 /// tests if all values in a vector of boost::optional are set to any defined value (optionally limited to an index range startidx--stopidx)
 template <typename T>
-inline bool allValuesSet(std::vector<boost::optional<T>>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
-  for (auto it = vec.begin(); it != vec.end(); ++it) {
-    auto index = std::distance(vec.begin(), it);
-    if (!*it && index >= startidx && index < stopidx)
-      return false;
-  }
-  return true;
+inline bool allValuesSet(const cadidaq::channelVector<T>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
+  stopidx = std::min(stopidx, vec.size());
+  return startidx >= stopidx || vec.countSet(startidx, stopidx) == stopidx - startidx;
 }
 
 /// tests if all values in a vector of boost::optional are unset/undefined (optionally limited to an index range startidx--stopidx)
 template <typename T>
-inline bool noValuesSet(std::vector<boost::optional<T>>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
-  for (auto it = vec.begin(); it != vec.end(); ++it) {
-    auto index = std::distance(vec.begin(), it);
-    if (*it && index >= startidx && index < stopidx)
+inline bool noValuesSet(const cadidaq::channelVector<T>& vec, size_t startidx = 0, size_t stopidx = std::numeric_limits<std::size_t>::max()){
+  return vec.firstSet(startidx, stopidx) >= vec.size();
+}
+
+/// syntax error found by parseChannelRange
+struct rangeError {
+  std::size_t position; ///< offset of the offending character in the range expression
+  const char* message;
+};
+
+/** parses a comma-separated list of channel numbers and ranges ("1, 4-7, 12") or '*' (all channels)
+    in a single pass and without allocating: the channels listed are set in mask (bit i%64 of word i/64
+    for channel i, (nChannels+63)/64 words which the caller has to clear). Whitespace may surround
+    the numbers and separators. Channels listed beyond nChannels are not set but passed to
+    outOfRange(first, last) (inclusive, once per range). Returns false and fills error on a syntax
+    error, leaving mask in an unspecified state.
+*/
+template <typename F>
+inline bool parseChannelRange(const char* begin, const char* end, std::size_t nChannels, uint64_t* mask, rangeError& error, F outOfRange){
+  // numbers are capped there, which is out of range anyhow
+  const uint64_t maxChannel = std::numeric_limits<uint32_t>::max();
+  const char* p = begin;
+  auto skipSpace = [&](){ while (p != end && (*p == ' ' || *p == '\t')) p++; };
+  auto fail = [&](const char* message){ error.position = p - begin; error.message = message; return false; };
+  auto isDigit = [](char c){ return c >= '0' && c <= '9'; };
+  auto number = [&](uint64_t& n){
+    if (p == end || !isDigit(*p))
       return false;
+    n = 0;
+    for (; p != end && isDigit(*p); p++)
+      n = std::min<uint64_t>(n*10 + (*p - '0'), maxChannel);
+    return true;
+  };
+  auto setRange = [&](uint64_t first, uint64_t last){
+    if (last >= nChannels)
+      outOfRange(std::max<uint64_t>(first, nChannels), last);
+    if (first >= nChannels)
+      return;
+    last = std::min<uint64_t>(last, nChannels - 1);
+    for (std::size_t w = first/64; w <= last/64; w++)
+      mask[w] |= cadidaq::detail::rangeBits(w, first, last + 1);
+  };
+
+  skipSpace();
+  if (p == end)
+    return fail("empty range");
+  while (true){
+    const char* item = p;
+    uint64_t first, last;
+    if (p != end && *p == '*'){
+      p++;
+      if (nChannels)
+        setRange(0, nChannels - 1);
+    } else {
+      if (!number(first))
+        return fail("expected a channel number or '*'");
+      last = first;
+      skipSpace();
+      if (p != end && *p == '-'){
+        p++;
+        skipSpace();
+        if (!number(last))
+          return fail("expected the channel number ending the range");
+        if (last < first){
+          p = item;
+          return fail("range ends before it starts");
+        }
+      }
+      setRange(first, last);
+    }
+    skipSpace();
+    if (p == end)
+      return true;
+    if (*p != ',')
+      return fail("expected ',' or the end of the range");
+    p++;
+    skipSpace();
   }
-  return true;
 }
 
-/// finds the common root-prefix for the enums in the given boost::bimap (e.g. "CAEN_DGTZ_")
-template <class CAEN_ENUM>
-inline std::string findEnumRoot(boost::bimap< std::string, CAEN_ENUM >& map){
-  std::string root = map.left.begin()->first;
-  for(const auto& item : map.left){
-    if (root.length() > item.first.length()){
-      root.erase(item.first.length(), std::string::npos);
-    }
-    for(int i = 0; i < root.length(); ++i){
-      if (root[i] != item.first[i]){
-        root.erase(i, std::string::npos);
-        break;
-      }
+/** formats the channels set in mask (bit i%64 of word i/64 for channel i) as a range expression
+    understood by parseChannelRange, e.g. "0-15,32"; "*" if all of the nChannels channels are set */
+inline std::string formatChannelRange(const uint64_t* mask, std::size_t nChannels){
+  auto isSet = [&](std::size_t i){ return (mask[i/64] >> (i%64)) & 1; };
+  std::size_t nWords = (nChannels + 63)/64, nSet = 0;
+  for (std::size_t w = 0; w < nWords; w++)
+    nSet += cadidaq::detail::popcount(mask[w] & cadidaq::detail::rangeBits(w, 0, nChannels));
+  if (nChannels > 0 && nSet == nChannels)
+    return "*";
+  std::string range;
+  for (std::size_t i = 0; i < nChannels; i++){
+    if (!isSet(i))
+      continue;
+    // find the end of the run of set channels starting here
+    std::size_t last = i;
+    while (last + 1 < nChannels && isSet(last + 1))
+      last++;
+    if (!range.empty())
+      range += ',';
+    range += std::to_string(i);
+    if (last > i)
+      range += '-' + std::to_string(last);
+    i = last;
+  }
+  return range;
+}
+
+namespace cadidaq {
+  namespace detail {
+    /// value of a hex digit or -1
+    inline int digitValue(char c){
+      if (c >= '0' && c <= '9') return c - '0';
+      if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+      if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+      return -1;
     }
   }
-  return root;
-}
-
-/** splits a comma-separated list of values and ranges into
-    individual values, returns these as vector */
-inline std::vector<int> expandRange(std::string range){
-  // clean input of spaces
-  boost::erase_all(range," ");
-  // helper vars
-  std::vector<std::string> strs,r;
-  std::vector<int> v;
-  int low,high,i;
-  // split string
-  boost::split(strs,range,boost::is_any_of(","));
-  // expand values
-  for (auto it:strs){
-    boost::split(r,it,boost::is_any_of("-"));
-    auto x = r.begin();
-    low = high =boost::lexical_cast<int>(r[0]);
-    x++;
-    if(x!=r.end())
-      high = boost::lexical_cast<int>(r[1]);
-    for(i=low;i<=high;++i)
-      v.push_back(i);
+}
+
+/** parses an integer in decimal or (with '0x' prefix) hex notation from [begin, end) without
+    allocating or consulting the locale. Only signed types accept a leading '-'. Fails on empty
+    input, on any other character and if the value does not fit into T. */
+template <typename T>
+inline bool parseInteger(const char* begin, const char* end, T& value){
+  typedef typename std::make_unsigned<T>::type U;
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '+' || (std::is_signed<T>::value && *p == '-')))
+    negative = *p++ == '-';
+  unsigned base = 10;
+  if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')){
+    base = 16;
+    p += 2;
+  }
+  if (p == end)
+    return false;
+  const U limit = negative ? U(std::numeric_limits<T>::max()) + 1 : U(std::numeric_limits<T>::max());
+  U n = 0;
+  for (; p != end; p++){
+    int d = cadidaq::detail::digitValue(*p);
+    if (d < 0 || (unsigned)d >= base || n > (limit - d)/base)
+      return false;
+    n = n*base + d;
   }
-  return v;
+  value = static_cast<T>(negative ? U(0) - n : n);
+  return true;
+}
+
+/** writes value in hex notation with '0x' prefix to out (which needs room for 2 + 2*sizeof(T)
+    characters) without allocating; returns the end of the written characters */
+template <typename T>
+inline char* formatHex(T value, char* out){
+  typedef typename std::make_unsigned<T>::type U;
+  const U u = static_cast<U>(value);
+  std::size_t digits = 1;
+  while (digits < 2*sizeof(T) && (u >> (4*digits)))
+    digits++;
+  *out++ = '0';
+  *out++ = 'x';
+  for (std::size_t i = digits; i-- > 0;)
+    *out++ = "0123456789abcdef"[(u >> (4*i)) & 0xf];
+  return out;
 }
 
 /// converts a string to a hex value
-inline boost::optional<uint32_t> str2hex(std::string str){
-  // clean input of spaces
-  boost::erase_all(str," ");
-  if (!str.empty()){
-      uint32_t i = 0;
-      if (boost::istarts_with(str, "0x")){
-        // treat as hex
-        std::stringstream ss(str);
-        ss >> std::hex >> i;
-        return boost::optional<uint32_t>(i);
-      } else {
-        // treat as number
-        try{
-          i = boost::lexical_cast<uint32_t>(str);
-        }
-        catch (boost::bad_lexical_cast){
-          return boost::optional<uint32_t>(boost::none);
-        }
-      }
-      // return result
-      return boost::optional<uint32_t>(i);
-    }
-  else
+inline boost::optional<uint32_t> str2hex(const char* begin, const char* end){
+  // ignore surrounding spaces
+  while (begin != end && *begin == ' ') begin++;
+  while (end != begin && end[-1] == ' ') end--;
+  uint32_t i;
+  if (!parseInteger(begin, end, i))
     return boost::optional<uint32_t>(boost::none);
+  return boost::optional<uint32_t>(i);
 }
 
-/// convert a uint32_t into a str in hex notation
-inline std::string hex2str(uint32_t i){
-  std::stringstream s;
-  s << std::hex << std::showbase << i;
-  return s.str();
+inline boost::optional<uint32_t> str2hex(const std::string& str){
+  return str2hex(str.data(), str.data() + str.size());
+}
+
+/// convert an unsigned integer into a str in hex notation
+template <typename T>
+inline std::string hex2str(T i){
+  char buffer[2 + 2*sizeof(T)];
+  return std::string(buffer, formatHex(i, buffer));
 }
 
 /// identifies last element in an iteration 
@@ -5,10 +5,8 @@
 #define CADIDAQ_hexTranslator_hpp
 
 #include <boost/property_tree/ptree.hpp>
-#include <boost/algorithm/string/predicate.hpp>
-#include <boost/algorithm/string.hpp>
-#include <boost/algorithm/string/predicate.hpp> // boost::starts_with
-#include <boost/lexical_cast.hpp>
+
+#include <helper.hpp> // parseInteger
 
 
 // Custom translator for hex (only supports std::string)
@@ -21,44 +19,11 @@ struct hexTranslator
     // Converts a (hex)string to int
   boost::optional<external_type> get_value(const internal_type& str)
     {
-        if (!str.empty())
-        {
-          external_type i;
-          if (boost::istarts_with(str, "0x")){
-            // treat as hex
-            std::size_t* pos;
-            std::size_t length = str.length();
-            try{
-              i = std::stoi(str, pos, 16);
-              }
-            catch (std::invalid_argument& e){
-              // no conversion performed
-              return boost::optional<external_type>(boost::none);
-            }
-            catch(std::out_of_range& e){
-              // if the converted value would fall out of the range of the result type
-              // or if the underlying function (std::strtol or std::strtoull) sets errno
-              // to ERANGE.
-              return boost::optional<external_type>(boost::none);
-            }
-            if (*pos != length){
-              // not all characters have been converted
-              return boost::optional<external_type>(boost::none);
-            }
-          } else {
-            // treat as number
-            try{
-              i = boost::lexical_cast<int>(str);
-            }
-            catch (boost::bad_lexical_cast){
-              return boost::optional<external_type>(boost::none);
-            }
-          }
-          // return result
-          return boost::optional<external_type>(i);
-        }
-        else
-            return boost::optional<external_type>(boost::none);
+      // decimal or, with '0x' prefix, hex notation covering the full range of the type
+      external_type i;
+      if (!parseInteger(str.data(), str.data() + str.size(), i))
+        return boost::optional<external_type>(boost::none);
+      return boost::optional<external_type>(i);
     }
 
     // Converts a int to string
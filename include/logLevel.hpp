@@ -0,0 +1,27 @@
+// logLevel.hpp
+#ifndef CADIDAQ_LOGLEVEL_H
+#define CADIDAQ_LOGLEVEL_H
+
+#include <boost/log/trivial.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+
+/** Compile-time severity threshold for the *_LOG_* macros
+
+    Records below CADIDAQ_LOG_MIN_SEVERITY (numeric value of
+    boost::log::trivial::severity_level, 0: trace ... 5: fatal) are removed by
+    the compiler: the condition below is a constant, so neither the record nor
+    any of the streamed expressions are evaluated. Levels at or above the
+    threshold are still subject to the runtime per-channel filter set up in
+    logging.cpp. Set through the CMake option CADIDAQ_STRIP_DEBUG_LOGGING.
+ */
+#ifndef CADIDAQ_LOG_MIN_SEVERITY
+#define CADIDAQ_LOG_MIN_SEVERITY 0
+#endif
+
+// a loop rather than if/else, so that an 'else' following the macro cannot bind to it
+#define CADIDAQ_LOG_CHANNEL_SEV(logger, chan, sev)                              \
+  for (bool cadidaqLogOn = static_cast<int>(sev) >= CADIDAQ_LOG_MIN_SEVERITY;   \
+       cadidaqLogOn; cadidaqLogOn = false)                                      \
+    BOOST_LOG_CHANNEL_SEV(logger, chan, sev)
+
+#endif
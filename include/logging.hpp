@@ -1,6 +1,11 @@
+#include <cstddef>
+#include <cstdint>
+
 #include <boost/log/trivial.hpp>
 #include <boost/log/sources/severity_channel_logger.hpp>
 
+#include <logLevel.hpp>
+
 /* namespace alias (commonly used in boost examples) */
 namespace logging = boost::log;
 namespace attrs = boost::log::attributes;
@@ -12,3 +17,9 @@ namespace keywords = boost::log::keywords;
 static boost::log::sources::severity_channel_logger< boost::log::trivial::severity_level, std::string > lg;
 
 void init_console_logging();
+/// moves console output to a dedicated formatting thread fed through a bounded lock-free queue; if dropOnOverflow, records are discarded instead of waiting while the queue is full
+void init_async_console_logging(std::size_t queueSize, bool dropOnOverflow);
+/// writes out all queued records and returns to synchronous console logging
+void stop_logging();
+/// number of records discarded by the asynchronous sink so far
+uint64_t dropped_log_records();
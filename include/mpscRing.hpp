@@ -0,0 +1,106 @@
+// mpscRing.hpp
+#ifndef CADIDAQ_MPSCRING_H
+#define CADIDAQ_MPSCRING_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include <cacheAligned.hpp>
+
+namespace cadidaq {
+  template <typename T> class mpscRing;
+}
+
+/** /class mpscRing
+    Bounded, lock-free multi-producer/single-consumer ring.
+
+    push() may be called from any number of threads, pop() only from one
+    (consumer) thread. Each slot carries a sequence number telling whether it
+    is free for the producer owning the current position or holds a value for
+    the consumer; producers claim positions through a compare-and-swap on the
+    head index. Neither side takes a lock or allocates memory; the storage is
+    allocated once in the constructor. The indices written by producers and
+    consumer live on separate cache lines. A full ring makes push() fail, leaving
+    it to the caller to either drop the value or retry.
+ */
+template <typename T>
+class cadidaq::mpscRing : public cadidaq::cacheAligned {
+public:
+  /// capacity is rounded up to the next power of two
+  mpscRing(std::size_t capacity) : head(0), nPushed(0), tail(0) {
+    std::size_t n = 1;
+    while (n < capacity) n <<= 1;
+    slots.reset(new slot[n]);
+    for (std::size_t i = 0; i < n; i++)
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    mask = n - 1;
+  }
+
+  /// producers: appends a value; returns false if the ring is full
+  bool push(const T& value){
+    std::size_t h = head.load(std::memory_order_relaxed);
+    slot* s;
+    while (true){
+      s = &slots[h & mask];
+      std::size_t seq = s->sequence.load(std::memory_order_acquire);
+      std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)h;
+      if (diff == 0){
+        // slot is free for position h: try to claim it
+        if (head.compare_exchange_weak(h, h + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0){
+        // slot still holds the value from one round before: full
+        return false;
+      } else {
+        // another producer claimed position h already
+        h = head.load(std::memory_order_relaxed);
+      }
+    }
+    s->value = value;
+    s->sequence.store(h + 1, std::memory_order_release);
+    nPushed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// consumer: removes the oldest value; returns false if the ring is empty (or the oldest value is still being written)
+  bool pop(T& value){
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    slot& s = slots[t & mask];
+    if (s.sequence.load(std::memory_order_acquire) != t + 1)
+      return false;
+    value = std::move(s.value);
+    s.value = T();
+    // free the slot for the producers of the next round
+    s.sequence.store(t + mask + 1, std::memory_order_release);
+    tail.store(t + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// approximate number of entries
+  std::size_t size() const {return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);}
+  bool empty() const {return size() == 0;}
+  std::size_t capacity() const {return mask + 1;}
+
+  /// statistics, safe to read from any thread
+  uint64_t pushed() const {return nPushed.load(std::memory_order_relaxed);}
+
+private:
+  struct slot {
+    std::atomic<std::size_t> sequence;
+    T                        value;
+  };
+
+  // read-only after construction
+  std::unique_ptr<slot[]>  slots;
+  std::size_t              mask;
+  // written by the producers
+  alignas(cacheLine) std::atomic<std::size_t> head;
+  std::atomic<uint64_t>    nPushed;
+  // written by the consumer (the size of the class is rounded up to a full line after it)
+  alignas(cacheLine) std::atomic<std::size_t> tail;
+};
+
+#endif
@@ -0,0 +1,118 @@
+// readout.hpp
+#ifndef CADIDAQ_READOUT_H
+#define CADIDAQ_READOUT_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include <boost/log/trivial.hpp>
+#include <boost/log/sources/severity_channel_logger.hpp>
+
+#include <settings.hpp>
+#include <spscRing.hpp>
+#include <eventDecoder.hpp>
+#include <timeMerger.hpp>
+
+namespace cadidaq {
+  class digitizer;
+  struct readoutBuffer;
+  struct timedRecord;
+  class readout;
+}
+
+/** /struct readoutBuffer
+    A block of raw data as transferred from a digitizer in a single ReadData call.
+*/
+struct cadidaq::readoutBuffer {
+  char*    data;      ///< memory allocated by the CAEN library
+  uint32_t size;      ///< allocated size in bytes
+  uint32_t dataSize;  ///< number of valid bytes from the last transfer
+  uint32_t nEvents;   ///< number of events contained in the valid bytes
+};
+
+/** /struct timedRecord
+    Entry of the stream of all digitizers merged in time order: an event of the standard firmware or a hit of a DPP
+    firmware, copied out of the readout buffer. Time tags of all boards are taken to count from a common start.
+*/
+struct cadidaq::timedRecord {
+  enum : uint8_t {EVENT = 0xFF}; ///< channel of the events of the standard firmware
+
+  uint64_t time;       ///< time tag extended across rollovers, in ns
+  uint32_t counter;    ///< event counter (standard firmware)
+  uint16_t energy;     ///< see dppHit
+  uint16_t chargeLong;
+  uint16_t fineTime;
+  uint16_t flags;
+  uint8_t  channel;
+  uint8_t  board;      ///< index of the digitizer in the readout
+};
+
+/** /class readout
+    Readout engine running one thread per digitizer that continuously reads block transfers into preallocated buffers.
+
+    Filled buffers are handed to a consumer thread through a lock-free SPSC ring per digitizer and returned to the
+    readout thread through a second ring once processed. If the consumer falls behind and no free buffer is left, the
+    readout thread keeps reading into a scratch buffer whose data is dropped so that the board never stalls.
+ */
+class cadidaq::readout {
+public:
+  /// hook called from the consumer thread for each buffer holding data (before the buffer is reused)
+  typedef std::function<void(cadidaq::digitizer*, const cadidaq::readoutBuffer&)> bufferHandler;
+  /// hook called from the consumer thread for each record of the merged stream
+  typedef std::function<void(const cadidaq::timedRecord&)> recordHandler;
+
+  readout(std::vector<cadidaq::digitizer*>& digitizers, cadidaq::daqSettings* settings);
+  ~readout();
+  void start();
+  void stop();
+  bool isRunning(){return running;}
+  void setHandler(bufferHandler h){handler = h;}
+  void setRecordHandler(recordHandler h){mergedHandler = h;}
+  void printStatistics();
+
+private:
+  typedef cadidaq::spscRing<cadidaq::readoutBuffer*> bufferRing;
+  typedef cadidaq::timeMerger<cadidaq::timedRecord>  recordMerger;
+
+  /// per-digitizer state of the readout
+  struct board {
+    cadidaq::digitizer*                   digi;
+    std::vector<cadidaq::readoutBuffer>   buffers;   ///< last entry is the scratch buffer used when dropping data
+    cadidaq::standardDecoder*             decoder;   ///< walks the events of the filled buffers (nullptr for DPP firmware); used by the consumer only
+    cadidaq::dppDecoder*                  hitDecoder; ///< walks the hits of the filled buffers of a board with DPP firmware (nullptr otherwise)
+    uint8_t                               index;
+    uint32_t                              firstInput; ///< of the board's inputs to the merger
+    uint64_t                              untimedHits; ///< hits left out of the merged stream for lack of a time tag
+    bufferRing*                           filled;    ///< readout thread -> consumer
+    bufferRing*                           free;      ///< consumer -> readout thread
+    std::thread                           thread;
+    std::atomic<uint64_t>                 transfers;
+    std::atomic<uint64_t>                 bytes;
+    std::atomic<uint64_t>                 events;
+    std::atomic<uint64_t>                 errors;
+    std::atomic<uint64_t>                 droppedTransfers;
+    std::atomic<uint64_t>                 droppedEvents;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point stopTime;
+  };
+
+  void readoutLoop(board* b, int cpu);
+  void consumerLoop();
+  bool consume();
+  void emit(const cadidaq::timedRecord& record){if (mergedHandler) mergedHandler(record);}
+
+  std::vector<board*>   boards;
+  std::thread           consumer;
+  std::atomic<bool>     consuming;
+  cadidaq::daqSettings* settings;
+  bufferHandler         handler;
+  recordMerger*         merger;    ///< nullptr unless merging; used by the consumer only
+  recordHandler         mergedHandler;
+  std::atomic<bool>     running;
+  boost::log::sources::severity_channel_logger< boost::log::trivial::severity_level, std::string > lg;
+};
+
+#endif
@@ -0,0 +1,59 @@
+// sampleUnpack.hpp
+#ifndef CADIDAQ_SAMPLEUNPACK_H
+#define CADIDAQ_SAMPLEUNPACK_H
+
+#include <cstdint>
+#include <vector>
+
+#include <eventDecoder.hpp>
+
+namespace cadidaq {
+  enum class simdLevel : uint8_t;
+  class sampleBuffer;
+
+  /// unpacks all samples of a channel to out (room for nSamples values)
+  typedef void (*unpackKernel)(const cadidaq::channelData& data, uint16_t* out);
+
+  /// widest instruction set the CPU running the program supports
+  cadidaq::simdLevel detectSimdLevel();
+  /// kernel for the sample layout using no instructions beyond level; all kernels give bit-identical results
+  cadidaq::unpackKernel selectUnpackKernel(cadidaq::sampleLayout layout, cadidaq::simdLevel level);
+}
+
+/// instruction sets of the unpack kernels
+enum class cadidaq::simdLevel : uint8_t {
+  SCALAR, ///< portable C++, a word (or block of 3 samples) at a time
+  SSE2,   ///< 128-bit vectors (x86)
+  AVX2    ///< 256-bit vectors with per-lane shifts and permutes (x86)
+};
+
+/** /class sampleBuffer
+    Samples of one channel at a time, in an array aligned to a 32-byte (AVX2) vector and padded with zeros to a
+    whole number of vectors, so that the samples can be processed with aligned vector loads and without a scalar
+    remainder. The storage only grows and is reused for the following channels.
+ */
+class cadidaq::sampleBuffer {
+public:
+  static constexpr std::size_t alignment = 32;
+  /// samples per vector, and the granularity of the padding
+  static constexpr uint32_t vectorSamples = alignment/sizeof(uint16_t);
+
+  sampleBuffer() : samples(nullptr), nSamples(0) {}
+  /// unpacks all samples of the channel (fastest kernel the CPU supports); returns the array
+  const uint16_t* unpack(const cadidaq::channelData& data);
+
+  const uint16_t* data() const   {return samples;}
+  uint32_t size() const          {return nSamples;}
+  /// samples including the zeros up to the end of the last vector
+  uint32_t paddedSize() const    {return (nSamples + vectorSamples - 1)/vectorSamples*vectorSamples;}
+
+private:
+  sampleBuffer(const sampleBuffer&) = delete;
+  sampleBuffer& operator=(const sampleBuffer&) = delete;
+
+  std::vector<uint16_t> storage; ///< room for the padded samples and the offset to the alignment
+  uint16_t*             samples; ///< first aligned element of storage
+  uint32_t              nSamples;
+};
+
+#endif
@@ -2,23 +2,30 @@
 #ifndef CADIDAQ_SETTINGS_H
 #define CADIDAQ_SETTINGS_H
 
+#include <string>
+#include <vector>
+#include <unordered_map>
+
 #include <boost/property_tree/ptree.hpp>
 #include <boost/optional.hpp>
 
-#include <boost/bimap.hpp>
-
 #include <boost/log/trivial.hpp>
 #include <boost/log/sources/severity_channel_logger.hpp>
 
 // CAEN
 #include <CAENDigitizerType.h>
 
+#include <channelVector.hpp>
+
 namespace pt = boost::property_tree;
 
 namespace cadidaq {
   class settingsBase;
   class connectionSettings;
   class registerSettings;
+  class daqSettings;
+  enum class settingScope;
+  enum class settingAccess;
 }
 
 /** /class settingsBase
@@ -27,7 +34,7 @@ namespace cadidaq {
 class cadidaq::settingsBase {
 public:
   settingsBase(std::string name);
-  ~settingsBase(){;}
+  virtual ~settingsBase(){;}
   void parse(pt::iptree *node);
   pt::iptree* createPTree();
   void fillPTree(pt::iptree *node);
@@ -40,7 +47,7 @@ public:
   using option = std::pair< boost::optional<T>, std::string >;
 
   template<class T>
-  using Vec = std::vector< boost::optional<T> >;
+  using Vec = cadidaq::channelVector<T>;
 
   template<class T>
   using optionVector = std::pair< Vec<T>, std::string >;
@@ -51,15 +58,20 @@ protected:
   enum class parseDirection {READING, WRITING};
   enum class parseFormat {DEFAULT, HEX, CAENEnum};
   template <class VALUE> void parseSetting(std::string settingName, pt::iptree *node, boost::optional<VALUE>& settingValue, parseDirection direction, parseFormat format = parseFormat::DEFAULT);
-  template <typename VALUE> void parseSetting(std::string settingName, pt::iptree *node, std::vector<boost::optional<VALUE>>& settingValue, parseDirection direction, parseFormat format = parseFormat::DEFAULT);
+  template <typename VALUE> void parseSetting(std::string settingName, pt::iptree *node, Vec<VALUE>& settingValue, parseDirection direction, parseFormat format = parseFormat::DEFAULT);
   /// overloaded methods using combined settings/setting's name nomenclature
   template <class VALUE> void parseSetting(option<VALUE>& setting, pt::iptree *node, parseDirection direction, parseFormat format = parseFormat::DEFAULT);
   template <typename VALUE> void parseSetting(optionVector<VALUE>& setting, pt::iptree *node, parseDirection direction, parseFormat format = parseFormat::DEFAULT);
   /// method to parse arbitrary register address-value pairs
   void parseRegisters(pt::iptree *node, std::vector< std::pair< uint32_t, uint32_t >>& registers, parseDirection direction);
+  /// keys of the section being parsed that belong to the given setting, i.e. "settingName[RANGE]" (case-insensitive)
+  const std::vector<std::string>& matchingKeys(const std::string& settingName);
 
 private:
   virtual void processPTree(pt::iptree *node, parseDirection direction){};
+  void indexKeys(pt::iptree *node);
+  /// keys of the section being parsed, grouped by their case-folded name without any "[RANGE]" suffix; only valid during parse()
+  std::unordered_map< std::string, std::vector<std::string> > keyIndex;
 };
 
 
@@ -82,6 +94,53 @@ private:
   virtual void processPTree(pt::iptree *node, parseDirection direction);
 };
 
+/// firmware/model a setting in CADIDAQ_REGISTER_SETTINGS applies to
+enum class cadidaq::settingScope {ANY, STANDARD, DPP, X751};
+/// how a setting in CADIDAQ_REGISTER_SETTINGS is programmed into the device
+enum class cadidaq::settingAccess {
+  COMMON,       ///< single value for the whole board
+  CHANNELS,     ///< one value per channel, or per group on devices with grouped channels
+  EACH_CHANNEL, ///< one value per channel, regardless of grouping (DPP parameters)
+  MASK,         ///< channel (or group) enable mask
+  CUSTOM        ///< programmed by digitizer::programCustomSetting (at the position of its row)
+};
+
+/** Table of all settings written to the digitizer after the connection is established.
+
+    Each row binds the registerSettings member, its key in the configuration file, the format used to parse it, the
+    firmware it applies to and how it is programmed, naming the caen::Digitizer set/get methods (without prefix) used
+    for ungrouped and grouped channels. Member declarations, names, parsing/output and programming are all generated
+    from this table; rows are processed in order, which is the order the settings are programmed in.
+ */
+#define CADIDAQ_REGISTER_SETTINGS(X)                                                                                                                                 \
+  /* data readout; DPP FW uses SetDPPEventAggregation instead */                                                                                                     \
+  X(option,       uint32_t,                    maxNumEventsBLT,     "Expert_MaxNumEventsBLT",      DEFAULT, STANDARD, COMMON,       MaxNumEventsBLT,         MaxNumEventsBLT)         \
+  /* trigger */                                                                                                                                                      \
+  X(option,       CAEN_DGTZ_TriggerMode_t,     swTriggerMode,       "SWTriggerMode",               DEFAULT, ANY,      COMMON,       SWTriggerMode,           SWTriggerMode)           \
+  X(option,       CAEN_DGTZ_TriggerMode_t,     externalTriggerMode, "ExternalTriggerMode",         DEFAULT, ANY,      COMMON,       ExternalTriggerMode,     ExternalTriggerMode)     \
+  X(option,       CAEN_DGTZ_IOLevel_t,         ioLevel,             "IOLevel",                     DEFAULT, ANY,      COMMON,       IOlevel,                 IOlevel)                 \
+  X(option,       CAEN_DGTZ_RunSyncMode_t,     runSyncMode,         "RunSynchronizationMode",      DEFAULT, ANY,      COMMON,       RunSynchronizationMode,  RunSynchronizationMode)  \
+  X(option,       CAEN_DGTZ_OutputSignalMode_t, outSignalMode,      "OutputSignalMode",            DEFAULT, ANY,      COMMON,       OutputSignalMode,        OutputSignalMode)        \
+  /* NOTE: the channel parameter of the trigger polarity is unused on boards without individual trigger polarity setting */                                        \
+  X(optionVector, CAEN_DGTZ_TriggerPolarity_t, chTriggerPolarity,   "ChannelTriggerPolarity",      DEFAULT, STANDARD, CHANNELS,     TriggerPolarity,         TriggerPolarity)         \
+  X(optionVector, uint32_t,                    chTriggerThreshold,  "ChannelTriggerTreshold",      DEFAULT, STANDARD, CHANNELS,     ChannelTriggerThreshold, GroupTriggerThreshold)   \
+  /* TODO: find out whether or not to call this with DPP FW present! Documentation not 100% clear on that.. (use DPPParams.selft = ... instead?) */              \
+  X(optionVector, CAEN_DGTZ_TriggerMode_t,     chSelfTrigger,       "ChannelSelfTrigger",          DEFAULT, ANY,      CHANNELS,     ChannelSelfTrigger,      GroupSelfTrigger)        \
+  /* acquisition; SetRecordLength requires a subsequent call to SetPostTriggerSize */                                                                               \
+  X(option,       CAEN_DGTZ_AcqMode_t,         acquisitionMode,     "AcquisitionMode",             DEFAULT, ANY,      COMMON,       AcquisitionMode,         AcquisitionMode)         \
+  X(option,       uint32_t,                    recordLength,        "RecordLength",                DEFAULT, ANY,      COMMON,       RecordLength,            RecordLength)            \
+  X(option,       uint32_t,                    postTriggerSize,     "PostTriggerSize",             DEFAULT, ANY,      COMMON,       PostTriggerSize,         PostTriggerSize)         \
+  X(optionVector, bool,                        chEnable,            "EnableChannel",               DEFAULT, ANY,      MASK,         ChannelEnableMask,       GroupEnableMask)         \
+  /* NOTE: x740 firmware supports individual 8-bit offsets within a group, not supported by the CAENdigitizer library */                                          \
+  X(optionVector, uint32_t,                    chDCOffset,          "ChannelDCOffset",             DEFAULT, ANY,      CHANNELS,     ChannelDCOffset,         GroupDCOffset)           \
+  X(option,       CAEN_DGTZ_EnaDis_t,          desMode,             "DESMode",                     DEFAULT, X751,     COMMON,       DESMode,                 DESMode)                 \
+  /* DPP FW; parameters are set channel-by-channel in contrast to the standard FW channel options */                                                               \
+  X(optionVector, uint32_t,                    dppPreTriggerSize,   "DPPPreTriggerSize",           DEFAULT, DPP,      CUSTOM,       DPPPreTriggerSize,       DPPPreTriggerSize)       \
+  X(optionVector, CAEN_DGTZ_PulsePolarity_t,   dppChPulsePolarity,  "DPPChannelPulsePolarity",     DEFAULT, DPP,      EACH_CHANNEL, ChannelPulsePolarity,    ChannelPulsePolarity)    \
+  X(option,       CAEN_DGTZ_DPP_AcqMode_t,     dppAcqMode,          "DPPAcquisitionMode",          DEFAULT, DPP,      CUSTOM,       DPPAcquisitionMode,      DPPAcquisitionMode)          \
+  X(option,       CAEN_DGTZ_DPP_SaveParam_t,   dppAcqModeParam,     "DPPAcquisitionModeParameter", DEFAULT, DPP,      CUSTOM,       DPPAcquisitionMode,      DPPAcquisitionMode)          \
+  X(option,       CAEN_DGTZ_DPP_TriggerMode_t, dppTriggermode,      "DPPTriggerMode",              DEFAULT, DPP,      COMMON,       DPPTriggerMode,          DPPTriggerMode)
+
 /** /class registerSettings
     Class to hold all configuration settings that can be written to the digitizer device after the connection is established.
 */
@@ -95,33 +154,46 @@ public:
   /// arbitrary register address-value pairs
   std::vector<std::pair<uint32_t, uint32_t>> registerValues;
 
-  /// data readout settings
-  option<uint32_t>                          maxNumEventsBLT;
-
-  /// trigger settings
-  option<CAEN_DGTZ_TriggerMode_t>           swTriggerMode;
-  option<CAEN_DGTZ_TriggerMode_t>           externalTriggerMode;
-  option<CAEN_DGTZ_IOLevel_t>               ioLevel;
-  optionVector<CAEN_DGTZ_TriggerMode_t>     chSelfTrigger;
-  optionVector<uint32_t>                    chTriggerThreshold;
-  optionVector<CAEN_DGTZ_TriggerPolarity_t> chTriggerPolarity;
-  option<CAEN_DGTZ_RunSyncMode_t>           runSyncMode;
-  option<CAEN_DGTZ_OutputSignalMode_t>      outSignalMode;
-
-  /// acquisition settings
-  option<CAEN_DGTZ_AcqMode_t>               acquisitionMode;
-  option<uint32_t>                          recordLength;
-  option<uint32_t>                          postTriggerSize;
-  optionVector<bool>                        chEnable;
-  optionVector<uint32_t>                    chDCOffset;
-  option<CAEN_DGTZ_EnaDis_t>                desMode;
-
-  /// DPP-FW settings
-  optionVector<uint32_t>                    dppPreTriggerSize;
-  optionVector<CAEN_DGTZ_PulsePolarity_t>   dppChPulsePolarity;
-  option<CAEN_DGTZ_DPP_AcqMode_t>           dppAcqMode;
-  option<CAEN_DGTZ_DPP_SaveParam_t>         dppAcqModeParam;
-  option<CAEN_DGTZ_DPP_TriggerMode_t>       dppTriggermode;
+  /// all settings of the setting table, see CADIDAQ_REGISTER_SETTINGS
+#define CADIDAQ_DECLARE_SETTING(CONTAINER, TYPE, MEMBER, KEY, FORMAT, SCOPE, ACCESS, CHANNEL, GROUP) \
+  CONTAINER<TYPE> MEMBER;
+  CADIDAQ_REGISTER_SETTINGS(CADIDAQ_DECLARE_SETTING)
+#undef CADIDAQ_DECLARE_SETTING
+
+private:
+  virtual void processPTree(pt::iptree *node, parseDirection direction);
+};
+
+/** /class daqSettings
+    Class to hold the settings of the DAQ application itself as given in the [CADIDAQ] section.
+*/
+class cadidaq::daqSettings : public settingsBase {
+public:
+  daqSettings(std::string name);
+  ~daqSettings(){;}
+
+  void verify();
+
+  /// acquisition time in seconds (0: run until interrupted)
+  option<uint32_t>                          runDuration;
+  /// number of preallocated readout buffers per digitizer
+  option<uint32_t>                          readoutBuffers;
+  /// pin each readout thread to its own CPU core
+  option<bool>                              pinReadoutThreads;
+  /// open and program all digitizers concurrently
+  option<bool>                              parallelConfiguration;
+  /// format and write log messages on a dedicated thread
+  option<bool>                              asyncLogging;
+  /// number of log records the asynchronous logging queue can hold
+  option<uint32_t>                          logQueueSize;
+  /// discard log records while the queue is full instead of waiting
+  option<bool>                              logDropOnOverflow;
+  /// directory for the binary trace files of the readout threads (no tracing if unset)
+  option<std::string>                       traceDirectory;
+  /// number of records each trace file holds before wrapping around
+  option<uint32_t>                          traceRecords;
+  /// reorder window in microseconds for merging the events and hits of all digitizers in time order (no merging if unset)
+  option<uint32_t>                          mergeWindow;
 
 private:
   virtual void processPTree(pt::iptree *node, parseDirection direction);
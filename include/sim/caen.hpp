@@ -0,0 +1,438 @@
+// simulated stand-in for jadaq's caen.hpp
+//
+// Provides a caen::Digitizer with the same interface as the jadaq C++ wrapper
+// around the CAEN digitizer library but without any hardware access: settings
+// are kept in memory and readData() produces a synthetic stream of
+// standard-firmware events (or DPP aggregates) at a configurable rate.
+// Selected at build time through the CMake option CADIDAQ_SIMULATION.
+
+#ifndef CADIDAQ_SIM_CAEN_HPP
+#define CADIDAQ_SIM_CAEN_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+
+#include <CAENDigitizerType.h>
+
+namespace caen {
+
+  /// exception thrown on (simulated) communication errors
+  class Error : public std::exception {
+  public:
+    Error(int code, const char* where) : code_(code), where_(where) {}
+    int code() const {return code_;}
+    const char* where() const {return where_;}
+    const char* what() const noexcept {return "simulated CAEN digitizer error";}
+  private:
+    int code_;
+    const char* where_;
+  };
+
+  /// knobs of the simulated device; modify before calling Digitizer::open()
+  struct SimulationParameters {
+    CAEN_DGTZ_BoardModel_t model = CAEN_DGTZ_V1751;
+    std::string modelName        = "V1751";
+    uint32_t channels            = 8;
+    uint32_t groups              = 1;
+    uint32_t ADCbits             = 10;
+    bool     dppFw               = false;
+    /// rate of synthetic triggers in Hz
+    double   eventRate           = 1000.;
+    /// period of the trigger time tag counter in ns
+    uint32_t tickPeriod          = 8;
+    /// ticks added to all time tags, e.g. to see the counter roll over early in a run
+    uint64_t timeTagOffset       = 0;
+    /// latency added to each (simulated) access to the device and to opening it, e.g. to mimic a slow link
+    std::chrono::microseconds callLatency{0};
+    std::chrono::microseconds openLatency{0};
+    /// every n-th access to the device fails with a caen::Error (0: never)
+    uint32_t failEvery           = 0;
+  };
+
+  /** reads the defaults of the simulation from the environment:
+      CADIDAQ_SIM_MODEL (V1720, V1724, V1740, V1751), CADIDAQ_SIM_DPP (0/1), CADIDAQ_SIM_EVENT_RATE (Hz),
+      CADIDAQ_SIM_CALL_LATENCY and CADIDAQ_SIM_OPEN_LATENCY (both in microseconds), CADIDAQ_SIM_FAIL_EVERY (n-th access fails),
+      CADIDAQ_SIM_TIME_OFFSET (ticks added to the time tags) */
+  inline SimulationParameters simulationFromEnvironment(){
+    SimulationParameters p;
+    if (const char* model = std::getenv("CADIDAQ_SIM_MODEL")){
+      std::string m(model);
+      if (m == "V1720"){
+        p.model = CAEN_DGTZ_V1720; p.channels = 8; p.groups = 1; p.ADCbits = 12; p.tickPeriod = 8;
+      } else if (m == "V1724"){
+        p.model = CAEN_DGTZ_V1724; p.channels = 8; p.groups = 1; p.ADCbits = 14; p.tickPeriod = 10;
+      } else if (m == "V1740"){
+        p.model = CAEN_DGTZ_V1740; p.channels = 64; p.groups = 8; p.ADCbits = 12; p.tickPeriod = 16;
+      }
+      if (m == "V1720" || m == "V1724" || m == "V1740")
+        p.modelName = m;
+    }
+    if (const char* dpp = std::getenv("CADIDAQ_SIM_DPP"))
+      p.dppFw = std::atoi(dpp) != 0;
+    if (const char* rate = std::getenv("CADIDAQ_SIM_EVENT_RATE"))
+      p.eventRate = std::atof(rate);
+    if (const char* latency = std::getenv("CADIDAQ_SIM_CALL_LATENCY"))
+      p.callLatency = std::chrono::microseconds(std::atol(latency));
+    if (const char* latency = std::getenv("CADIDAQ_SIM_OPEN_LATENCY"))
+      p.openLatency = std::chrono::microseconds(std::atol(latency));
+    if (const char* fail = std::getenv("CADIDAQ_SIM_FAIL_EVERY"))
+      p.failEvery = std::atoi(fail);
+    if (const char* offset = std::getenv("CADIDAQ_SIM_TIME_OFFSET"))
+      p.timeTagOffset = std::strtoull(offset, nullptr, 0);
+    return p;
+  }
+
+  inline SimulationParameters& simulation(){
+    static SimulationParameters parameters = simulationFromEnvironment();
+    return parameters;
+  }
+
+  class Digitizer {
+  public:
+    struct ReadoutBuffer {
+      char*    data;
+      uint32_t size;
+      uint32_t dataSize;
+    };
+
+    static Digitizer* open(CAEN_DGTZ_ConnectionType /*linkType*/, int linkNum, int conetNode, uint32_t /*VMEBaseAddress*/){
+      if (simulation().openLatency.count() > 0)
+        std::this_thread::sleep_for(simulation().openLatency);
+      return new Digitizer(simulation(), (uint32_t)(linkNum*8 + conetNode));
+    }
+
+    // board information (queried from the device with each call, as by the CAEN library)
+    std::string modelName()       {access(false); return sim.modelName;}
+    uint32_t modelNo()            {access(false); return sim.model;}
+    uint32_t channels()           {access(false); return sim.channels;}
+    uint32_t groups()             {access(false); return sim.groups;}
+    uint32_t channelsPerGroup()   {access(false); return perGroup();}
+    uint32_t formFactor()         {access(false); return 0;}
+    uint32_t familyCode()         {access(false); return sim.model;}
+    std::string ROCfirmwareRel()  {access(false); return "sim";}
+    std::string AMCfirmwareRel()  {access(false); return std::to_string(sim.dppFw ? dppFirmware() : 0) + ".sim";}
+    std::string license()         {access(false); return "simulated";}
+    uint32_t serialNumber()       {access(false); return serial;}
+    uint32_t PCBrevision()        {access(false); return 0;}
+    uint32_t ADCbits()            {access(false); return sim.ADCbits;}
+    bool hasDppFw()               {access(false); return sim.dppFw;}
+    bool isDppCiFw()              {access(false); return false;}
+    bool is751Family()            {access(false); return sim.model == CAEN_DGTZ_V1751;}
+
+    // registers
+    void writeRegister(uint32_t address, uint32_t value)  {access(); registers[address] = value;}
+    uint32_t readRegister(uint32_t address)               {access(); return registers[address];}
+
+    // readout settings
+    void setMaxNumEventsBLT(uint32_t n)                   {access(); maxNumEventsBLT = n;}
+    uint32_t getMaxNumEventsBLT()                         {access(); return maxNumEventsBLT;}
+
+    // trigger settings
+    void setSWTriggerMode(CAEN_DGTZ_TriggerMode_t m)      {access(); swTriggerMode = m;}
+    CAEN_DGTZ_TriggerMode_t getSWTriggerMode()            {access(); return swTriggerMode;}
+    void setExternalTriggerMode(CAEN_DGTZ_TriggerMode_t m){access(); extTriggerMode = m;}
+    CAEN_DGTZ_TriggerMode_t getExternalTriggerMode()      {access(); return extTriggerMode;}
+    void setIOlevel(CAEN_DGTZ_IOLevel_t l)                {access(); ioLevel = l;}
+    CAEN_DGTZ_IOLevel_t getIOlevel()                      {access(); return ioLevel;}
+    void setRunSynchronizationMode(CAEN_DGTZ_RunSyncMode_t m)   {access(); runSyncMode = m;}
+    CAEN_DGTZ_RunSyncMode_t getRunSynchronizationMode()         {access(); return runSyncMode;}
+    void setOutputSignalMode(CAEN_DGTZ_OutputSignalMode_t m)    {access(); outSignalMode = m;}
+    CAEN_DGTZ_OutputSignalMode_t getOutputSignalMode()          {access(); return outSignalMode;}
+    void setTriggerPolarity(uint32_t ch, CAEN_DGTZ_TriggerPolarity_t p)  {access(); triggerPolarity.at(ch) = p;}
+    CAEN_DGTZ_TriggerPolarity_t getTriggerPolarity(uint32_t ch)          {access(); return triggerPolarity.at(ch);}
+    void setChannelTriggerThreshold(uint32_t ch, uint32_t t)    {access(); threshold.at(ch) = t;}
+    uint32_t getChannelTriggerThreshold(uint32_t ch)            {access(); return threshold.at(ch);}
+    void setGroupTriggerThreshold(uint32_t gr, uint32_t t)      {access(); threshold.at(gr) = t;}
+    uint32_t getGroupTriggerThreshold(uint32_t gr)              {access(); return threshold.at(gr);}
+    void setChannelSelfTrigger(uint32_t ch, CAEN_DGTZ_TriggerMode_t m)   {access(); selfTrigger.at(ch) = m;}
+    CAEN_DGTZ_TriggerMode_t getChannelSelfTrigger(uint32_t ch)           {access(); return selfTrigger.at(ch);}
+    void setGroupSelfTrigger(uint32_t gr, CAEN_DGTZ_TriggerMode_t m)     {access(); selfTrigger.at(gr) = m;}
+    CAEN_DGTZ_TriggerMode_t getGroupSelfTrigger(uint32_t gr)             {access(); return selfTrigger.at(gr);}
+
+    // acquisition settings
+    void setAcquisitionMode(CAEN_DGTZ_AcqMode_t m)        {access(); acqMode = m;}
+    CAEN_DGTZ_AcqMode_t getAcquisitionMode()              {access(); return acqMode;}
+    void setRecordLength(uint32_t l)                      {access(); recordLength = l;}
+    uint32_t getRecordLength()                            {access(); return recordLength;}
+    void setPostTriggerSize(uint32_t p)                   {access(); postTriggerSize = p;}
+    uint32_t getPostTriggerSize()                         {access(); return postTriggerSize;}
+    void setChannelEnableMask(uint32_t m)                 {access(); enableMask = m;}
+    uint32_t getChannelEnableMask()                       {access(); return enableMask;}
+    void setGroupEnableMask(uint32_t m)                   {access(); enableMask = m;}
+    uint32_t getGroupEnableMask()                         {access(); return enableMask;}
+    void setChannelDCOffset(uint32_t ch, uint32_t o)      {access(); dcOffset.at(ch) = o;}
+    uint32_t getChannelDCOffset(uint32_t ch)              {access(); return dcOffset.at(ch);}
+    void setGroupDCOffset(uint32_t gr, uint32_t o)        {access(); dcOffset.at(gr) = o;}
+    uint32_t getGroupDCOffset(uint32_t gr)                {access(); return dcOffset.at(gr);}
+    void setDESMode(CAEN_DGTZ_EnaDis_t m)                 {access(); desMode = m;}
+    CAEN_DGTZ_EnaDis_t getDESMode()                       {access(); return desMode;}
+
+    // DPP settings
+    void setDPPPreTriggerSize(int ch, uint32_t s){
+      access();
+      if (ch < 0) std::fill(preTrigger.begin(), preTrigger.end(), s);
+      else preTrigger.at(ch) = s;
+    }
+    uint32_t getDPPPreTriggerSize(int ch)                 {access(); return preTrigger.at(ch < 0 ? 0 : ch);}
+    void setChannelPulsePolarity(uint32_t ch, CAEN_DGTZ_PulsePolarity_t p)   {access(); pulsePolarity.at(ch) = p;}
+    CAEN_DGTZ_PulsePolarity_t getChannelPulsePolarity(uint32_t ch)           {access(); return pulsePolarity.at(ch);}
+    void setDPPAcquisitionMode(CAEN_DGTZ_DPP_AcqMode_t m, CAEN_DGTZ_DPP_SaveParam_t p)     {access(); dppAcqMode = m; dppSaveParam = p;}
+    void getDPPAcquisitionMode(CAEN_DGTZ_DPP_AcqMode_t& m, CAEN_DGTZ_DPP_SaveParam_t& p)   {access(); m = dppAcqMode; p = dppSaveParam;}
+    void setDPPTriggerMode(CAEN_DGTZ_DPP_TriggerMode_t m) {access(); dppTriggerMode = m;}
+    CAEN_DGTZ_DPP_TriggerMode_t getDPPTriggerMode()       {access(); return dppTriggerMode;}
+
+    /// number of (simulated) accesses to the device so far
+    uint64_t simulatedCalls()   {return calls;}
+
+    // acquisition control and readout
+    void startAcquisition(){
+      access();
+      running = true;
+      eventCounter = 0;
+      aggregateCounter = 0;
+      pendingEvents = 0.;
+      start = lastRead = std::chrono::steady_clock::now();
+    }
+    void stopAcquisition()  {access(); running = false;}
+    void clearData()        {access(); pendingEvents = 0.;}
+
+    ReadoutBuffer mallocReadoutBuffer(){
+      ReadoutBuffer b;
+      uint32_t words = sim.dppFw ? aggregateSize(std::max<uint32_t>(maxNumEventsBLT, 1)) : std::max<uint32_t>(maxNumEventsBLT, 1)*eventSize();
+      b.size = std::max<uint32_t>(4096, words*sizeof(uint32_t));
+      b.data = new char[b.size];
+      b.dataSize = 0;
+      return b;
+    }
+    void freeReadoutBuffer(ReadoutBuffer b)   {delete[] b.data;}
+
+    /// fills the buffer with the events (with DPP firmware: one aggregate of the hits) triggered since the last call
+    ReadoutBuffer& readData(ReadoutBuffer& buffer, CAEN_DGTZ_ReadMode_t /*mode*/){
+      access();
+      buffer.dataSize = 0;
+      if (!running)
+        return buffer;
+      auto now = std::chrono::steady_clock::now();
+      pendingEvents += sim.eventRate*std::chrono::duration<double>(now - lastRead).count();
+      lastRead = now;
+      if (sim.dppFw)
+        return readAggregate(buffer);
+      uint32_t nwords = eventSize();
+      uint32_t nevents = std::min<double>(pendingEvents, std::max<uint32_t>(maxNumEventsBLT, 1));
+      nevents = std::min(nevents, buffer.size/(nwords*(uint32_t)sizeof(uint32_t)));
+      uint32_t* out = reinterpret_cast<uint32_t*>(buffer.data);
+      for (uint32_t i = 0; i < nevents; i++){
+        double t = eventCounter/sim.eventRate;  // seconds since start of acquisition
+        out[0] = 0xA0000000 | nwords;
+        out[1] = ((serial & 0x1F) << 27) | (enableMask & 0xFF);
+        out[2] = eventCounter & 0xFFFFFF;
+        out[3] = (uint32_t)((sim.timeTagOffset + (uint64_t)(t*1e9/sim.tickPeriod)) & 0x7FFFFFFF);
+        fillSamples(out + 4);
+        out += nwords;
+        eventCounter++;
+      }
+      pendingEvents -= nevents;
+      buffer.dataSize = nevents*nwords*sizeof(uint32_t);
+      return buffer;
+    }
+
+    uint32_t getNumEvents(ReadoutBuffer& buffer){
+      uint32_t n = 0;
+      const uint32_t* w = reinterpret_cast<const uint32_t*>(buffer.data);
+      for (uint32_t pos = 0; pos < buffer.dataSize/sizeof(uint32_t) && (w[pos] & 0x0FFFFFFF); pos += w[pos] & 0x0FFFFFFF)
+        n++;
+      return n;
+    }
+
+  private:
+    Digitizer(const SimulationParameters& p, uint32_t serial) : sim(p), serial(serial),
+      threshold(p.channels), selfTrigger(p.channels), triggerPolarity(p.channels), dcOffset(p.channels),
+      preTrigger(p.channels), pulsePolarity(p.channels) {}
+
+    /// accounts for a round-trip to the device; failures are only injected into accesses that mayFail
+    void access(bool mayFail = true){
+      calls++;
+      if (sim.callLatency.count() > 0)
+        std::this_thread::sleep_for(sim.callLatency);
+      if (mayFail && sim.failEvery > 0 && ++failCounter % sim.failEvery == 0)
+        throw Error(CAEN_DGTZ_CommError, "simulated device access");
+    }
+
+    uint32_t perGroup() const {return sim.groups > 1 ? sim.channels/sim.groups : 1;}
+
+    /// number of channels (groups) enabled in the mask
+    uint32_t enabledBlocks(){
+      uint32_t n = 0;
+      for (uint32_t i = 0; i < std::min<uint32_t>(sim.channels/perGroup(), 32); i++)
+        if (enableMask & (1u << i)) n++;
+      return n;
+    }
+
+    /// words of sample data per channel, or per group of channels as on the x740 (3 samples of each of 8 channels in 9 words)
+    uint32_t blockSize(){
+      if (sim.groups > 1)
+        return (recordLength + 2)/3*9;
+      uint32_t samplesPerWord = (sim.ADCbits == 10) ? 3 : 2;
+      return (recordLength + samplesPerWord - 1)/samplesPerWord;
+    }
+
+    /// size of one event in 32-bit words: header plus packed samples of all enabled channels
+    uint32_t eventSize(){
+      return 4 + enabledBlocks()*blockSize();
+    }
+
+    /// flat baseline with a small, deterministic ripple as sample data: sample i of channel c is 0x200 + ((event + c + i) & 0xF)
+    void fillSamples(uint32_t* out){
+      uint32_t adcMask = (1u << sim.ADCbits) - 1;
+      uint32_t block = blockSize();
+      for (uint32_t b = 0; b < std::min<uint32_t>(sim.channels/perGroup(), 32); b++){
+        if (!(enableMask & (1u << b)))
+          continue;
+        if (sim.groups > 1){
+          // stream of 12-bit values: per 9 words 3 samples of each channel of the group, channel by channel
+          std::fill(out, out + block, 0);
+          for (uint32_t v = 0; v < block*32/12; v++){
+            uint32_t c = b*perGroup() + (v%24)/3, i = (v/24)*3 + v%3;
+            uint64_t s = (0x200 + ((eventCounter + c + i) & 0xF)) & adcMask;
+            uint32_t bit = v*12;
+            out[bit/32] |= (uint32_t)(s << (bit%32));
+            if (bit%32 > 20)
+              out[bit/32 + 1] |= (uint32_t)(s >> (32 - bit%32));
+          }
+        } else {
+          uint32_t perWord = (sim.ADCbits == 10) ? 3 : 2;
+          for (uint32_t w = 0; w < block; w++){
+            out[w] = 0;
+            for (uint32_t k = 0; k < perWord; k++){
+              uint32_t s = (0x200 + ((eventCounter + b + w*perWord + k) & 0xF)) & adcMask;
+              out[w] |= s << ((perWord == 3 ? 10 : 16)*k);
+            }
+          }
+        }
+        out += block;
+      }
+    }
+
+    /// AMC firmware code of the DPP firmware of the model: DPP-PHA on the x724, DPP-QDC on the x740, DPP-PSD otherwise
+    uint32_t dppFirmware() const {
+      switch (sim.model){
+      case CAEN_DGTZ_V1724: return 128;
+      case CAEN_DGTZ_V1740: return 135;
+      case CAEN_DGTZ_V1751: return 132;
+      default:              return 131;
+      }
+    }
+
+    /// format word of the channel aggregates: energy and time tag as requested by the save parameter, extras always, samples unless in list mode
+    uint32_t dppFormat(){
+      bool energy = dppSaveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyOnly || dppSaveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime;
+      bool time = dppSaveParam == CAEN_DGTZ_DPP_SAVE_PARAM_TimeOnly || dppSaveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime;
+      bool samples = dppAcqMode != CAEN_DGTZ_DPP_ACQ_MODE_List;
+      return (energy ? 1u << 30 : 0) | (time ? 1u << 29 : 0) | (1u << 28) | (samples ? (1u << 27) | ((recordLength + 7)/8 & 0xFFFF) : 0);
+    }
+
+    /// words per hit in a channel aggregate
+    uint32_t hitSize(){
+      uint32_t format = dppFormat();
+      return ((format >> 29) & 1) + ((format >> 27) & 1)*(format & 0xFFFF)*4 + 1 + ((format >> 30) & 1);
+    }
+
+    /// largest size of a board aggregate holding n hits in 32-bit words
+    uint32_t aggregateSize(uint32_t n){
+      return 4 + 2*enabledBlocks() + n*hitSize();
+    }
+
+    /// writes the hits triggered since the last call as a board aggregate: hit k goes to the k-th enabled channel (round robin),
+    /// its waveform follows the pattern of fillSamples, its energy is (7*k + channel) & 0x7FFF and the long charge twice that
+    ReadoutBuffer& readAggregate(ReadoutBuffer& buffer){
+      uint32_t channels[8], nChannels = 0;
+      for (uint32_t c = 0; c < std::min<uint32_t>(sim.channels, 8); c++)
+        if (enableMask & (1u << c)) channels[nChannels++] = c;
+      uint32_t nhits = std::min<double>(pendingEvents, std::max<uint32_t>(maxNumEventsBLT, 1));
+      while (nhits > 0 && aggregateSize(nhits)*sizeof(uint32_t) > buffer.size)
+        nhits--;
+      if (nChannels == 0 || nhits == 0)
+        return buffer;
+      uint32_t format = dppFormat(), nSamples = ((format >> 27) & 1) ? (format & 0xFFFF)*8 : 0;
+      uint32_t adcMask = (1u << sim.ADCbits) - 1;
+      uint32_t* out = reinterpret_cast<uint32_t*>(buffer.data);
+      uint32_t* w = out + 4;
+      uint32_t mask = 0;
+      for (uint32_t idx = 0; idx < nChannels; idx++){
+        uint32_t c = channels[idx];
+        uint32_t* aggregate = w;
+        w += 2;
+        for (uint32_t k = eventCounter + (idx + nChannels - eventCounter%nChannels)%nChannels; k < eventCounter + nhits; k += nChannels){
+          uint64_t ticks = sim.timeTagOffset + (uint64_t)(k/sim.eventRate*1e9/sim.tickPeriod);
+          if (format & (1u << 29))
+            *w++ = ticks & 0x7FFFFFFF;
+          for (uint32_t i = 0; i < nSamples; i += 2)
+            *w++ = ((0x200 + ((k + c + i) & 0xF)) & adcMask) | (((0x200 + ((k + c + i + 1) & 0xF)) & adcMask) << 16);
+          *w++ = (uint32_t)((ticks >> 31) & 0xFFFF) << 16 | (k & 0x3FF);
+          uint32_t energy = (7*k + c) & 0x7FFF;
+          if (format & (1u << 30))
+            *w++ = (dppFirmware() == 128 ? 0 : (2*energy & 0xFFFF) << 16) | energy;
+        }
+        if (w == aggregate + 2){
+          // no hits in this channel: no channel aggregate
+          w = aggregate;
+          continue;
+        }
+        aggregate[0] = 0x80000000 | (uint32_t)(w - aggregate);
+        aggregate[1] = format;
+        mask |= 1u << c;
+      }
+      out[0] = 0xA0000000 | (uint32_t)(w - out);
+      out[1] = ((serial & 0x1F) << 27) | mask;
+      out[2] = aggregateCounter++ & 0x7FFFFF;
+      out[3] = (uint32_t)((sim.timeTagOffset + (uint64_t)(eventCounter/sim.eventRate*1e9/sim.tickPeriod)) & 0xFFFFFFFF);
+      eventCounter += nhits;
+      pendingEvents -= nhits;
+      buffer.dataSize = (w - out)*sizeof(uint32_t);
+      return buffer;
+    }
+
+    SimulationParameters sim;
+    uint32_t serial;
+    std::map<uint32_t, uint32_t> registers;
+
+    uint32_t maxNumEventsBLT = 1;
+    CAEN_DGTZ_TriggerMode_t swTriggerMode          = CAEN_DGTZ_TRGMODE_DISABLED;
+    CAEN_DGTZ_TriggerMode_t extTriggerMode         = CAEN_DGTZ_TRGMODE_DISABLED;
+    CAEN_DGTZ_IOLevel_t ioLevel                    = CAEN_DGTZ_IOLevel_NIM;
+    CAEN_DGTZ_RunSyncMode_t runSyncMode            = CAEN_DGTZ_RUN_SYNC_Disabled;
+    CAEN_DGTZ_OutputSignalMode_t outSignalMode     = CAEN_DGTZ_TRIGGER;
+    CAEN_DGTZ_AcqMode_t acqMode                    = CAEN_DGTZ_SW_CONTROLLED;
+    uint32_t recordLength                          = 1024;
+    uint32_t postTriggerSize                       = 50;
+    uint32_t enableMask                            = 0xFF;
+    CAEN_DGTZ_EnaDis_t desMode                     = CAEN_DGTZ_DISABLE;
+    CAEN_DGTZ_DPP_AcqMode_t dppAcqMode             = CAEN_DGTZ_DPP_ACQ_MODE_List;
+    CAEN_DGTZ_DPP_SaveParam_t dppSaveParam         = CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime;
+    CAEN_DGTZ_DPP_TriggerMode_t dppTriggerMode     = CAEN_DGTZ_DPP_TriggerMode_Normal;
+    std::vector<uint32_t> threshold;
+    std::vector<CAEN_DGTZ_TriggerMode_t> selfTrigger;
+    std::vector<CAEN_DGTZ_TriggerPolarity_t> triggerPolarity;
+    std::vector<uint32_t> dcOffset;
+    std::vector<uint32_t> preTrigger;
+    std::vector<CAEN_DGTZ_PulsePolarity_t> pulsePolarity;
+
+    uint64_t calls = 0;
+    uint64_t failCounter = 0;
+    bool running = false;
+    uint32_t eventCounter = 0;
+    uint32_t aggregateCounter = 0;
+    double pendingEvents = 0.;
+    std::chrono::steady_clock::time_point start, lastRead;
+  };
+}
+
+#endif
@@ -0,0 +1,100 @@
+// spscRing.hpp
+#ifndef CADIDAQ_SPSCRING_H
+#define CADIDAQ_SPSCRING_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <cacheAligned.hpp>
+
+namespace cadidaq {
+  template <typename T> class spscRing;
+}
+
+/** /class spscRing
+    Bounded, lock-free single-producer/single-consumer ring.
+
+    push() may only be called from one (producer) thread and pop() from one
+    (consumer) thread. Neither takes a lock or allocates memory; the storage
+    is allocated once in the constructor. Head and tail indices live on
+    separate cache lines so that producer and consumer do not false-share,
+    and each side keeps a cached copy of the other side's index to avoid
+    touching the shared line on every call. The producer also keeps track of
+    the highest occupancy and of pushes rejected because the ring was full.
+ */
+template <typename T>
+class cadidaq::spscRing : public cadidaq::cacheAligned {
+public:
+  /// capacity is rounded up to the next power of two
+  spscRing(std::size_t capacity) : head(0), cachedTail(0), nPushed(0), nDropped(0), highWater(0), tail(0), cachedHead(0) {
+    std::size_t n = 1;
+    while (n < capacity) n <<= 1;
+    slots.resize(n);
+    mask = n - 1;
+  }
+
+  /// producer: appends a value; returns false (and counts a drop) if the ring is full
+  bool push(const T& value){
+    std::size_t h = head.load(std::memory_order_relaxed);
+    if (h - cachedTail > mask){
+      cachedTail = tail.load(std::memory_order_acquire);
+      if (h - cachedTail > mask){
+        nDropped.store(nDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    slots[h & mask] = value;
+    head.store(h + 1, std::memory_order_release);
+    nPushed.store(nPushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    // the cached tail may be stale, so this only bounds the occupancy from above: a possible new maximum is checked
+    // against the consumer's current tail
+    if (h + 1 - cachedTail > highWater.load(std::memory_order_relaxed)){
+      cachedTail = tail.load(std::memory_order_acquire);
+      std::size_t occupancy = h + 1 - cachedTail;
+      if (occupancy > highWater.load(std::memory_order_relaxed))
+        highWater.store(occupancy, std::memory_order_relaxed);
+    }
+    return true;
+  }
+
+  /// consumer: removes the oldest value; returns false if the ring is empty
+  bool pop(T& value){
+    std::size_t t = tail.load(std::memory_order_relaxed);
+    if (t == cachedHead){
+      cachedHead = head.load(std::memory_order_acquire);
+      if (t == cachedHead)
+        return false;
+    }
+    value = slots[t & mask];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// approximate number of entries (exact only if called from producer or consumer while the other side is idle)
+  std::size_t size() const {return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);}
+  bool empty() const {return size() == 0;}
+  std::size_t capacity() const {return mask + 1;}
+
+  /// statistics, safe to read from any thread
+  uint64_t pushed() const {return nPushed.load(std::memory_order_relaxed);}
+  uint64_t dropped() const {return nDropped.load(std::memory_order_relaxed);}
+  std::size_t highWaterMark() const {return highWater.load(std::memory_order_relaxed);}
+
+private:
+  // read-only after construction
+  std::vector<T>           slots;
+  std::size_t              mask;
+  // written by the producer
+  alignas(cacheLine) std::atomic<std::size_t> head;
+  std::size_t              cachedTail;
+  std::atomic<uint64_t>    nPushed;
+  std::atomic<uint64_t>    nDropped;
+  std::atomic<std::size_t> highWater;
+  // written by the consumer (the size of the class is rounded up to a full line after these)
+  alignas(cacheLine) std::atomic<std::size_t> tail;
+  std::size_t              cachedHead;
+};
+
+#endif
@@ -0,0 +1,196 @@
+// timeMerger.hpp
+#ifndef CADIDAQ_TIMEMERGER_H
+#define CADIDAQ_TIMEMERGER_H
+
+#include <vector>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+
+namespace cadidaq {
+  template <typename T> class timeMerger;
+}
+
+/** /class timeMerger
+    K-way merge of time-stamped records (T needs a uint64_t member `time`) from several inputs, each of them mostly in
+    time order, into a single stream in time order.
+
+    Records wait in a FIFO per input; a tournament tree over the heads of the FIFOs (the winner stored at each node,
+    so that any input can change its head) finds the earliest record in log2(K) comparisons. A record is released once
+    a record more than the reorder window later has been pushed to any input, so inputs may lag each other, and
+    records may come behind their input's latest one, by up to the window. Records arriving after a later one has
+    been released are late: they are passed on at once, out of order, and counted. An input whose FIFO reaches its
+    maximum size also forces the earliest records out. The FIFOs grow by doubling up to that size, so that memory is
+    only allocated while the merge warms up.
+ */
+template <typename T>
+class cadidaq::timeMerger {
+public:
+  /// window in the units of T::time; maxQueue (rounded up to a power of two) bounds the records waiting per input
+  timeMerger(std::size_t inputs, uint64_t window, std::size_t maxQueue = 1 << 16)
+    : queues(inputs), window(window), maxSeen(0), lastReleased(0), released(false), nBuffered(0),
+      nMerged(0), nLate(0), nForced(0), highWater(0) {
+    leaves = 1;
+    while (leaves < inputs) leaves <<= 1;
+    maxSize = 1;
+    while (maxSize < maxQueue || maxSize < 64) maxSize <<= 1;
+    keys.assign(2*leaves, empty);
+    who.resize(2*leaves);
+    for (std::size_t i = 0; i < leaves; i++)
+      who[leaves + i] = i;
+    for (std::size_t n = leaves - 1; n > 0; n--)
+      who[n] = who[2*n];
+  }
+
+  /// adds a record of the input; calls emit(const T&, std::size_t input) for late records and records forced out
+  template <typename F>
+  void push(std::size_t input, const T& record, F emit){
+    if (released && record.time < lastReleased){
+      nLate++;
+      emit(record, input);
+      return;
+    }
+    queue& q = queues[input];
+    if (q.count > q.mask){
+      if (q.count < maxSize)
+        q.grow();
+      else {
+        // release the earliest records, some of which are the input's own, until there is room again
+        while (q.count == maxSize){
+          nForced++;
+          pop(emit);
+        }
+        if (record.time < lastReleased){
+          nLate++;
+          emit(record, input);
+          return;
+        }
+      }
+    }
+    std::size_t i = q.count;
+    if (record.time >= q.latest)
+      q.latest = record.time;
+    else {
+      // behind the input's latest record: sort it in from the back
+      while (i > 0 && q.at(i - 1).time > record.time){
+        q.at(i) = q.at(i - 1);
+        i--;
+      }
+    }
+    q.at(i) = record;
+    q.count++;
+    if (record.time > maxSeen)
+      maxSeen = record.time;
+    if (++nBuffered > highWater)
+      highWater = nBuffered;
+    // only a new head changes the matches
+    if (i == 0)
+      update(input);
+  }
+
+  /// calls emit for all records at least the window before the latest one, in time order
+  template <typename F>
+  void release(F emit){
+    if (maxSeen < window)
+      return;
+    uint64_t limit = maxSeen - window;
+    while (nBuffered > 0 && keys[1] <= limit)
+      pop(emit);
+  }
+
+  /// calls emit for all waiting records, in time order (e.g. at the end of the acquisition)
+  template <typename F>
+  void flush(F emit){
+    while (nBuffered > 0)
+      pop(emit);
+  }
+
+  std::size_t inputs() const       {return queues.size();}
+  uint64_t getWindow() const       {return window;}
+  /// records waiting for release
+  std::size_t getBuffered() const  {return nBuffered;}
+  std::size_t highWaterMark() const{return highWater;}
+  /// records released in time order
+  uint64_t getMerged() const       {return nMerged;}
+  /// records passed on out of order as a later record had already been released
+  uint64_t getLate() const         {return nLate;}
+  /// records released before the window had passed because the FIFO of an input was full
+  uint64_t getForced() const       {return nForced;}
+
+private:
+  static const uint64_t empty = std::numeric_limits<uint64_t>::max();
+
+  /// FIFO of an input, kept in time order
+  struct queue {
+    std::vector<T> slots;
+    std::size_t    mask;
+    std::size_t    first;
+    std::size_t    count;
+    uint64_t       latest; ///< latest time pushed
+    queue() : slots(64), mask(63), first(0), count(0), latest(0) {}
+    T& at(std::size_t i){return slots[(first + i) & mask];}
+    void grow(){
+      std::vector<T> larger(2*slots.size());
+      for (std::size_t i = 0; i < count; i++)
+        larger[i] = at(i);
+      slots.swap(larger);
+      mask = slots.size() - 1;
+      first = 0;
+    }
+  };
+
+  /// replays the matches on the path from the leaf of the input to the root
+  void update(std::size_t input){
+    std::size_t n = leaves + input;
+    const queue& q = queues[input];
+    uint64_t key = q.count ? q.slots[q.first & q.mask].time : empty;
+    std::size_t winner = input;
+    keys[n] = key;
+    // the winner is carried up in registers and only met by the siblings on the path, which this update does not change
+    for (; n > 1; n >>= 1){
+      uint64_t other = keys[n ^ 1];
+      // ties go to the lower input (the left subtree) so that the order does not depend on the arrival
+      // (selected with masks: which input wins is as good as random, a branch would mostly be mispredicted)
+      uint64_t lost = (other < key) | ((n & 1) & (other == key));
+      uint64_t mask = 0 - lost;
+      key ^= (key ^ other) & mask;
+      winner ^= (winner ^ who[n ^ 1]) & mask;
+      keys[n >> 1] = key;
+      who[n >> 1] = winner;
+    }
+  }
+
+  template <typename F>
+  void pop(F& emit){
+    std::size_t input = who[1];
+    queue& q = queues[input];
+    const T& record = q.slots[q.first & q.mask];
+    lastReleased = record.time;
+    released = true;
+    nMerged++;
+    nBuffered--;
+    emit(record, input);
+    q.first++;
+    q.count--;
+    update(input);
+  }
+
+  std::vector<queue>       queues;
+  std::vector<uint64_t>    keys;   ///< time of the earliest record of the subtree of each node; leaves from index `leaves`
+  std::vector<std::size_t> who;    ///< input of that record
+  std::size_t              leaves;
+  std::size_t              maxSize;
+  uint64_t                 window;
+  uint64_t                 maxSeen;
+  uint64_t                 lastReleased;
+  bool                     released;
+  std::size_t              nBuffered;
+  uint64_t                 nMerged;
+  uint64_t                 nLate;
+  uint64_t                 nForced;
+  std::size_t              highWater;
+};
+
+template <typename T> const uint64_t cadidaq::timeMerger<T>::empty;
+
+#endif
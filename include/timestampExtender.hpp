@@ -0,0 +1,132 @@
+// timestampExtender.hpp
+#ifndef CADIDAQ_TIMESTAMPEXTENDER_H
+#define CADIDAQ_TIMESTAMPEXTENDER_H
+
+#include <cstdint>
+
+namespace cadidaq {
+  class timestampExtender;
+}
+
+/** /class timestampExtender
+    Extends the time tags of a board, which count ticks in a counter of a few tens of bits, to a monotonic
+    64-bit time by counting the rollovers of the counter.
+
+    Time tags are compared modulo the range of the counter: a tag up to `window` ticks behind the latest one is
+    taken as late (as hits of different channels of a DPP aggregate are) and placed before the latest time without
+    moving it; any other tag moves the time forward, across a rollover if it is smaller than the latest tag.
+    Rollovers are therefore lost only if the board stays silent for more than range - window ticks. Extending a
+    tag is a handful of integer operations, with predictable branches and without waiting for the previous result.
+ */
+class cadidaq::timestampExtender {
+public:
+  /// counter of `bits` bits (up to 63); window defaults to an eighth of its range
+  explicit timestampExtender(uint32_t bits = 31, uint64_t window = 0)
+    : nBits(bits), mask((uint64_t(1) << bits) - 1), window(window ? window : (mask >> 3)), epoch(0), last(0), offset(0), first(0),
+      started(false), resumed(false), resumeAt(0), resumeTag(0), resumeMask(0), nRollovers(0), nLate(0) {}
+
+  /// time of the tag (bits beyond the counter are ignored) in ticks since the rollover preceding the first tag
+  /// (0 for late tags from before that rollover)
+  uint64_t extend(uint64_t tag){
+    tag &= mask;
+    if (!started)
+      return start(tag);
+    // only compared with the previous tag, so that consecutive tags do not wait for each other's time
+    uint64_t ahead = (tag - last) & mask;
+    if (ahead > mask - window){
+      // late tag: before the latest one, and before the latest rollover if larger than the latest tag
+      nLate++;
+      uint64_t time = offset + epoch + tag;
+      if (tag > last)
+        time -= mask + 1;
+      // (a time below 0 wrapped around)
+      return int64_t(time) >= 0 ? time : 0;
+    }
+    if (tag < last){
+      epoch += mask + 1;
+      nRollovers++;
+    }
+    last = tag;
+    return offset + epoch + tag;
+  }
+
+  /// changes the width of the counter (as the optional words of DPP hits do), continuing from the latest time:
+  /// the tags of either width share the low bits of the same counter
+  void setBits(uint32_t bits, uint64_t window = 0){
+    if (bits == nBits)
+      return;
+    uint64_t newMask = (uint64_t(1) << bits) - 1;
+    if (started){
+      resumed = true;
+      resumeAt = latest();
+      resumeTag = last;
+      resumeMask = mask < newMask ? mask : newMask;
+    }
+    nBits = bits;
+    mask = newMask;
+    this->window = window ? window : (mask >> 3);
+    epoch = last = 0;
+    started = false;
+  }
+
+  /// forgets all tags and counts, e.g. when the board's counter restarts with a new acquisition
+  void reset(){
+    epoch = last = offset = first = 0;
+    started = resumed = false;
+    resumeAt = resumeTag = resumeMask = 0;
+    nRollovers = nLate = 0;
+  }
+
+  uint32_t bits() const          {return nBits;}
+  /// latest time in ticks
+  uint64_t latest() const        {return started ? offset + epoch + last : resumeAt;}
+  /// ticks from the first tag to the latest time
+  uint64_t span() const          {return latest() - first;}
+  uint64_t getRollovers() const  {return nRollovers;}
+  /// tags placed before the latest time
+  uint64_t getLateTags() const   {return nLate;}
+
+private:
+  /// first tag, or the first after a change of the counter's width
+  uint64_t start(uint64_t tag){
+    started = true;
+    last = tag;
+    if (!resumed){
+      first = tag;
+      return tag;
+    }
+    // continue from the latest tag of the previous width by the difference of the bits both have
+    resumed = false;
+    uint64_t ahead = (tag - resumeTag) & resumeMask;
+    if (ahead > resumeMask - (resumeMask >> 3)){
+      // late: the latest time stays, at the tag it has in the new width
+      nLate++;
+      uint64_t behind = resumeMask + 1 - ahead;
+      last = (tag + behind) & mask;
+      offset = resumeAt - last;
+      return resumeAt >= behind ? resumeAt - behind : 0;
+    }
+    // (when the counter widens, the previous tag lacks the bits telling whether the wider counter rolled over)
+    if (resumeMask == mask && tag < (resumeTag & mask))
+      nRollovers++;
+    offset = resumeAt + ahead - tag;
+    return resumeAt + ahead;
+  }
+
+  uint32_t nBits;
+  uint64_t mask;
+  uint64_t window;
+  uint64_t epoch;      ///< ticks of the rollovers so far (at the current width)
+  uint64_t last;       ///< latest tag
+  uint64_t offset;     ///< time of tag 0 of the first epoch at the current width, 0 unless the width changed
+  uint64_t first;      ///< time of the first tag
+  bool     started;
+  bool     resumed;    ///< the width changed: the next tag continues from resumeAt
+  uint64_t resumeAt;   ///< latest time at the previous width
+  uint64_t resumeTag;  ///< latest tag at the previous width
+  uint64_t resumeMask; ///< bits tags of both widths have
+  uint64_t nRollovers;
+  uint64_t nLate;
+};
+
+#endif
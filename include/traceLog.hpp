@@ -0,0 +1,105 @@
+// traceLog.hpp
+#ifndef CADIDAQ_TRACELOG_H
+#define CADIDAQ_TRACELOG_H
+
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace cadidaq {
+  enum class traceEvent : uint16_t;
+  struct traceRecord;
+  struct traceFileHeader;
+  class traceLog;
+}
+
+/// kinds of records written to the binary "trace" channel; meaning of the record's arguments given in brackets
+enum class cadidaq::traceEvent : uint16_t {
+  ACQUISITION_START = 1, ///< acquisition started
+  ACQUISITION_STOP,      ///< acquisition stopped [a1: transfers, a2: events]
+  TRANSFER,              ///< block transfer handed to the consumer [a0: events, a1: bytes]
+  DROPPED_TRANSFER,      ///< block transfer dropped for lack of a free buffer [a0: events, a1: bytes]
+  READ_ERROR             ///< failed block transfer [a0: consecutive failures]
+};
+
+/// fixed-size entry of a trace file
+struct cadidaq::traceRecord {
+  uint64_t time;  ///< steady clock, ns
+  uint16_t event; ///< cadidaq::traceEvent
+  uint16_t reserved;
+  uint32_t a0;
+  uint64_t a1;
+  uint64_t a2;
+};
+
+/** /struct traceFileHeader
+    Start of a trace file, followed by `capacity` traceRecords used as a ring.
+    `head` counts all records ever written, so the oldest record still in the
+    file is at position max(0, head - capacity) (modulo capacity). All members
+    are plain integers, as in the file: the writer accesses `head` through the
+    __atomic builtins, readers copy the header out of the file.
+ */
+struct cadidaq::traceFileHeader {
+  static constexpr const char* magicString = "CADITRC1";
+  static const uint32_t currentVersion = 1;
+
+  char                  magic[8];
+  uint32_t              version;
+  uint32_t              recordSize;
+  uint64_t              capacity;    ///< number of records, power of two
+  uint64_t              head;        ///< number of records written, published with release semantics
+  int64_t               clockOffset; ///< system clock minus steady clock (ns) when the file was opened
+  char                  source[64];  ///< value of the "Digitizer" log attribute
+  char                  padding[24];
+};
+
+static_assert(sizeof(cadidaq::traceRecord) == 32, "trace records have to be 32 bytes");
+static_assert(sizeof(cadidaq::traceFileHeader) == 128, "trace file header has to be 128 bytes");
+static_assert(std::is_trivially_copyable<cadidaq::traceFileHeader>::value, "trace file header is copied from and to the file as bytes");
+
+/** /class traceLog
+    Binary trace channel for high-rate diagnostics of the readout.
+
+    Each instance belongs to a single thread and writes fixed-size records
+    into a memory-mapped ring file, overwriting the oldest records once the
+    ring is full. Recording an event is a clock read and a few stores, with
+    no formatting, locking or system call; the kernel writes the pages back
+    to the file (which is therefore also readable after a crash). Files are
+    rendered offline by the cadidaq-trace tool. A closed traceLog silently
+    ignores all records.
+ */
+class cadidaq::traceLog {
+public:
+  traceLog() : header(nullptr), records(nullptr), mask(0), mapSize(0) {}
+  ~traceLog(){close();}
+  /// creates (or truncates) the file holding a ring of at least `capacity` records; returns false and sets errno on failure
+  bool open(const std::string& path, const std::string& source, std::size_t capacity);
+  void close();
+  bool isOpen() const {return header != nullptr;}
+
+  void record(cadidaq::traceEvent event, uint32_t a0 = 0, uint64_t a1 = 0, uint64_t a2 = 0){
+    if (!header)
+      return;
+    uint64_t h = __atomic_load_n(&header->head, __ATOMIC_RELAXED);
+    traceRecord& r = records[h & mask];
+    r.time  = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    r.event = static_cast<uint16_t>(event);
+    r.a0    = a0;
+    r.a1    = a1;
+    r.a2    = a2;
+    __atomic_store_n(&header->head, h + 1, __ATOMIC_RELEASE);
+  }
+
+private:
+  traceLog(const traceLog&) = delete;
+  traceLog& operator=(const traceLog&) = delete;
+
+  traceFileHeader* header;
+  traceRecord*     records;
+  uint64_t         mask;
+  std::size_t      mapSize;
+};
+
+#endif
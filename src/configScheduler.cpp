@@ -0,0 +1,80 @@
+#include <configScheduler.hpp>
+
+#include <string>
+#include <thread>
+#include <chrono>
+
+#include <digitizer.hpp>
+
+#include <logLevel.hpp> // CADIDAQ_LOG_CHANNEL_SEV
+
+#define CFG_LOG_DEBUG                                           \
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::debug)
+#define CFG_LOG_INFO                                          \
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::info)
+#define CFG_LOG_ERROR                                         \
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::error)
+
+cadidaq::configScheduler::configScheduler(){
+}
+
+void cadidaq::configScheduler::add(cadidaq::digitizer* digi, pt::iptree* node){
+  job j = {digi, node, 0., false, nullptr};
+  jobs.push_back(j);
+}
+
+/// configures a single digitizer; all logging of the board is attributed to it through the digitizer's own logger.
+/// Nothing may escape: an exception leaving a worker thread would terminate the program.
+void cadidaq::configScheduler::configure(job* j){
+  auto start = std::chrono::steady_clock::now();
+  try{
+    j->connected = j->digi->configure(j->node);
+  }
+  catch (...){
+    j->connected = false;
+    j->error = std::current_exception();
+  }
+  j->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool cadidaq::configScheduler::run(bool parallel){
+  CFG_LOG_INFO << "Configuring " << jobs.size() << " digitizer(s) " << (parallel ? "in parallel" : "sequentially");
+  auto start = std::chrono::steady_clock::now();
+  if (parallel){
+    std::vector<std::thread> threads;
+    for (auto& j : jobs)
+      threads.push_back(std::thread(&cadidaq::configScheduler::configure, &j));
+    for (auto& t : threads)
+      t.join();
+  } else {
+    for (auto& j : jobs)
+      configure(&j);
+  }
+  double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double sum = 0.;
+  bool ok = true;
+  for (auto& j : jobs){
+    sum += j.seconds;
+    if (j.error){
+      try{
+        std::rethrow_exception(j.error);
+      }
+      catch (const std::exception& e){
+        CFG_LOG_ERROR << "\t Configuring digitizer '" << j.digi->getName() << "' failed after " << j.seconds << " s: " << e.what();
+      }
+      catch (...){
+        CFG_LOG_ERROR << "\t Configuring digitizer '" << j.digi->getName() << "' failed after " << j.seconds << " s with an unknown exception";
+      }
+      ok = false;
+    } else if (!j.connected){
+      CFG_LOG_ERROR << "\t Could not connect to digitizer '" << j.digi->getName() << "' (after " << j.seconds << " s)";
+      ok = false;
+    } else if (j.digi->getErrors() > 0)
+      CFG_LOG_INFO << "\t Configured digitizer '" << j.digi->getName() << "' in " << j.seconds << " s (" << j.digi->getErrors() << " failed device call(s))";
+    else
+      CFG_LOG_INFO << "\t Configured digitizer '" << j.digi->getName() << "' in " << j.seconds << " s";
+  }
+  CFG_LOG_INFO << "Configuration of all digitizers took " << total << " s (sum over boards: " << sum << " s)";
+  jobs.clear();
+  return ok;
+}
@@ -9,25 +9,49 @@
 #include <boost/log/attributes/constant.hpp>
 
 #include <iomanip>   // std::hex
+#include <sstream>
 
 #include <helper.hpp>       // helper functions
+#include <readout.hpp>      // readoutBuffer
 #include <caen.hpp>
 
 namespace pt = boost::property_tree;
 
+#include <logLevel.hpp> // CADIDAQ_LOG_CHANNEL_SEV
+
 #define DG_LOG_DEBUG                                          \
-  BOOST_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::debug)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::debug)
 #define DG_LOG_INFO                                           \
-  BOOST_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::info)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::info)
 #define DG_LOG_WARN                                             \
-  BOOST_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::warning)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::warning)
 #define DG_LOG_ERROR                                          \
-  BOOST_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::error)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::error)
 #define DG_LOG_FATAL                                          \
-  BOOST_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::fatal)
-
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "dig", boost::log::trivial::fatal)
+
+
+/// maximum number of distinct kinds of errors listed in the report of a single pass over the settings
+static const std::size_t maxListedErrors = 16;
+
+/** ns per tick of the trigger time tags of the board, from the family in its model name (e.g. 751 for "VX1751"):
+    the clock of the trigger time tag of the standard firmware, the sampling period for the DPP firmwares of the
+    x725 and x730 whose time stamps count samples */
+static uint32_t tickPeriodOf(const cadidaq::boardInfo& info){
+  const char* begin = std::find_if(info.model.data(), info.model.data() + info.model.size(), [](char c){return c >= '0' && c <= '9';});
+  const char* end = std::find_if(begin, info.model.data() + info.model.size(), [](char c){return c < '0' || c > '9';});
+  uint32_t number = 0;
+  parseInteger(begin, end, number);
+  switch (number%1000){
+  case 724: return 10;
+  case 740: return 16;
+  case 725: return info.hasDppFw ? 4 : 8;
+  case 730: return info.hasDppFw ? 2 : 8;
+  default:  return 8; // x720, x751 and others
+  }
+}
 
-cadidaq::digitizer::digitizer(std::string name) : name(name), lnk(nullptr), dg(nullptr), reg(nullptr){
+cadidaq::digitizer::digitizer(std::string name) : dg(nullptr), lnk(nullptr), reg(nullptr), shadow(nullptr), nWrites(0), nElidedWrites(0), nMergedWrites(0), nErrors(0), nUnlistedErrors(0), name(name), info(){
   // Register a constant attribute that identifies our digitizer in the logs
   lg.add_attribute("Digitizer", boost::log::attributes::constant<std::string>(name));
 }
@@ -38,13 +62,23 @@ cadidaq::digitizer::~digitizer(){
   if (lnk)
     delete lnk;
   if (reg)
-    delete lnk;
+    delete reg;
+  if (shadow)
+    delete shadow;
 }
 
-void cadidaq::digitizer::configure(pt::iptree *node){
+bool cadidaq::digitizer::configure(pt::iptree *node){
   if (dg != nullptr){
-    DG_LOG_FATAL << "Digitizer '" << name << "' already configured!";
-    return;
+    // already connected: only (re-)program the register settings, skipping whatever is already on the device
+    DG_LOG_INFO << "Digitizer '" << name << "' already connected, reprogramming settings.";
+    // the link settings only apply when connecting: take them out of the section as on the first call
+    cadidaq::connectionSettings link(name);
+    link.parse(node);
+    if ((link.linkType && link.linkType != lnk->linkType) || (link.linkNum && link.linkNum != lnk->linkNum)
+        || (link.conetNode && link.conetNode != lnk->conetNode) || (link.vmeBaseAddress && link.vmeBaseAddress != lnk->vmeBaseAddress))
+      DG_LOG_WARN << "Connection settings of digitizer '" << name << "' changed: they only take effect when connecting again, keeping the current connection.";
+    programRegisterSettings(node);
+    return true;
   }
   lnk = new cadidaq::connectionSettings(name);
   // parse and store the link settings
@@ -64,24 +98,52 @@ void cadidaq::digitizer::configure(pt::iptree *node){
     if (!dg){
       // TODO: more fine-grained error handling, more info on log
       DG_LOG_ERROR << "Please check the physical connection and the connection settings. If using USB link, please make sure that the CAEN USB driver kernel module is installed and loaded, especially after kernel updates (or use DKMS as explained in INSTALL.md).";
-      // won't be able to handle this much more gracefully than:
-      exit(EXIT_FAILURE);
+      // other boards may still be configuring: leave it to the caller to give up
+      return false;
     }
   }
+  // snapshot of the static board properties
+  info.model            = dg->modelName();
+  info.modelNo          = dg->modelNo();
+  info.serial           = dg->serialNumber();
+  info.channels         = dg->channels();
+  info.groups           = dg->groups();
+  info.channelsPerGroup = dg->channelsPerGroup();
+  info.adcBits          = dg->ADCbits();
+  info.hasDppFw         = dg->hasDppFw();
+  info.isDppCiFw        = dg->isDppCiFw();
+  info.is751Family      = dg->is751Family();
+  info.license          = dg->license();
+  info.formFactor       = dg->formFactor();
+  info.familyCode       = dg->familyCode();
+  info.rocFirmware      = dg->ROCfirmwareRel();
+  info.amcFirmware      = dg->AMCfirmwareRel();
+  info.pcbRevision      = dg->PCBrevision();
+  info.tickPeriod       = tickPeriodOf(info);
   // status printout
   DG_LOG_INFO << "Connected to digitzer '" << name << "'" << std::endl
-                 << "\t Model:\t\t"           << dg->modelName() << " (numeric model number: " << dg->modelNo() << ")" << std::endl
-                 << "\t NChannels:\t"         << dg->channels() << " (in " << dg->groups() << " groups)" << std::endl
-                 << "\t ADC bits:\t"          << dg->ADCbits() << std::endl
-                 << "\t license:\t"           << dg->license() << std::endl
-                 << "\t Form factor:\t"       << dg->formFactor() << std::endl
-                 << "\t Family code:\t"       << dg->familyCode() << std::endl
-                 << "\t Serial number:\t"     << dg->serialNumber() << std::endl
-                 << "\t ROC FW rel.:\t"       << dg->ROCfirmwareRel() << std::endl
-                 << "\t AMC FW rel.:\t"       << dg->AMCfirmwareRel() << ", uses DPP FW: " << (dg->hasDppFw() ? "yes" : "no") << std::endl
-                 << "\t PCB rev.:\t"          << dg->PCBrevision() << std::endl;
-
-  reg = new cadidaq::registerSettings(name, dg->channels());
+                 << "\t Model:\t\t"           << info.model << " (numeric model number: " << info.modelNo << ")" << std::endl
+                 << "\t NChannels:\t"         << info.channels << " (in " << info.groups << " groups)" << std::endl
+                 << "\t ADC bits:\t"          << info.adcBits << std::endl
+                 << "\t license:\t"           << info.license << std::endl
+                 << "\t Form factor:\t"       << info.formFactor << std::endl
+                 << "\t Family code:\t"       << info.familyCode << std::endl
+                 << "\t Serial number:\t"     << info.serial << std::endl
+                 << "\t ROC FW rel.:\t"       << info.rocFirmware << std::endl
+                 << "\t AMC FW rel.:\t"       << info.amcFirmware << ", uses DPP FW: " << (info.hasDppFw ? "yes" : "no") << std::endl
+                 << "\t PCB rev.:\t"          << info.pcbRevision << std::endl
+                 << "\t Time tag tick:\t"     << info.tickPeriod << " ns" << std::endl;
+
+  // nothing known about the device state yet
+  shadow = new cadidaq::registerSettings(name, info.channels);
+  programRegisterSettings(node);
+  return true;
+}
+
+void cadidaq::digitizer::programRegisterSettings(pt::iptree *node){
+  if (reg)
+    delete reg;
+  reg = new cadidaq::registerSettings(name, info.channels);
   reg->parse(node);
   reg->verify();
   // call our own verification routine to check model-dependent options
@@ -92,7 +154,6 @@ void cadidaq::digitizer::configure(pt::iptree *node){
   for (auto& key : *node){
     DG_LOG_WARN << "Unknown setting in section " << name << " ignored: \t" << key.first << " = " << key.second.get_value<std::string>();
   }
-
 }
 
 pt::iptree* cadidaq::digitizer::retrieveConfig(){
@@ -108,249 +169,478 @@ pt::iptree* cadidaq::digitizer::retrieveConfig(){
   return node;
 }
 
+//
+// acquisition and readout
+//
+
+bool cadidaq::digitizer::startAcquisition(){
+  try{
+    dg->clearData();
+    dg->startAcquisition();
+  }
+  catch (caen::Error& e){
+    DG_LOG_ERROR << "Caught exception when starting acquisition on digitizer '" << name << "': calling " << e.where() << " caused exception: " << e.what();
+    return false;
+  }
+  DG_LOG_INFO << "Acquisition started";
+  return true;
+}
+
+void cadidaq::digitizer::stopAcquisition(){
+  try{
+    dg->stopAcquisition();
+  }
+  catch (caen::Error& e){
+    DG_LOG_ERROR << "Caught exception when stopping acquisition on digitizer '" << name << "': calling " << e.where() << " caused exception: " << e.what();
+    return;
+  }
+  DG_LOG_INFO << "Acquisition stopped";
+}
+
+/** Allocates a buffer large enough for a block transfer of 'maxNumEventsBLT' events.
+    NOTE: the size depends on the configuration of the board, i.e. call only after configure(). */
+bool cadidaq::digitizer::allocateBuffer(readoutBuffer& buffer){
+  try{
+    caen::Digitizer::ReadoutBuffer b = dg->mallocReadoutBuffer();
+    buffer.data = b.data;
+    buffer.size = b.size;
+  }
+  catch (caen::Error& e){
+    DG_LOG_ERROR << "Caught exception when allocating readout buffer for digitizer '" << name << "': calling " << e.where() << " caused exception: " << e.what();
+    buffer.data = nullptr;
+    buffer.size = 0;
+    return false;
+  }
+  buffer.dataSize = 0;
+  buffer.nEvents = 0;
+  return true;
+}
+
+void cadidaq::digitizer::freeBuffer(readoutBuffer& buffer){
+  if (!buffer.data)
+    return;
+  caen::Digitizer::ReadoutBuffer b = {buffer.data, buffer.size, buffer.dataSize};
+  dg->freeReadoutBuffer(b);
+  buffer.data = nullptr;
+  buffer.size = 0;
+}
+
+/// performs a single block transfer into the given buffer; returns false on communication errors
+bool cadidaq::digitizer::readData(readoutBuffer& buffer){
+  caen::Digitizer::ReadoutBuffer b = {buffer.data, buffer.size, 0};
+  try{
+    dg->readData(b, CAEN_DGTZ_SLAVE_TERMINATED_READOUT_MBLT);
+    buffer.dataSize = b.dataSize;
+    buffer.nEvents = (b.dataSize > 0) ? dg->getNumEvents(b) : 0;
+  }
+  catch (caen::Error& e){
+    DG_LOG_ERROR << "Caught exception when reading data from digitizer '" << name << "': calling " << e.where() << " caused exception: " << e.what();
+    buffer.dataSize = 0;
+    buffer.nEvents = 0;
+    return false;
+  }
+  return true;
+}
+
 //
 // programming configuration into digitizer
 //
 
 
 
+/** Collects a failed device call instead of logging it right away: calls failing with the same message are counted
+    and only the arguments of their first occurrence are kept (context is only evaluated then). The collected errors
+    are logged by reportErrors() at the end of a pass over the settings. */
+template <typename F>
+void cadidaq::digitizer::recordError(const caen::Error& e, F context){
+  nErrors++;
+  for (auto& err : errors){
+    if (err.call == e.where() && err.message == e.what()){
+      err.count++;
+      return;
+    }
+  }
+  if (errors.size() >= maxListedErrors){
+    nUnlistedErrors++;
+    return;
+  }
+  deviceError err = {e.where(), e.what(), context(), 1};
+  errors.push_back(err);
+}
+
+/// logs the errors collected since the last report as a single record
+void cadidaq::digitizer::reportErrors(comDirection direction){
+  if (errors.empty())
+    return;
+  uint64_t total = nUnlistedErrors;
+  for (auto& err : errors)
+    total += err.count;
+  // TODO: more fine-grained error handling
+  std::stringstream report;
+  report << total << " device call(s) failed when " << (direction == comDirection::WRITING ? "programming" : "reading back")
+         << " settings of digitizer " << info.model << ", serial " << info.serial << ":";
+  for (auto& err : errors)
+    report << std::endl << "\t " << err.count << "x calling " << err.call << " caused exception: " << err.message << " (first for " << err.firstContext << ")";
+  if (nUnlistedErrors > 0)
+    report << std::endl << "\t " << nUnlistedErrors << " further failed call(s) of other kinds";
+  DG_LOG_ERROR << report.str();
+  errors.clear();
+  nUnlistedErrors = 0;
+}
+
+/** The 'known' arguments of the wrappers refer to the corresponding entry in the shadow copy of the device state:
+    writes of values identical to the known state are skipped, successful reads and writes update the known state and
+    failed ones invalidate it. Settings without a value are neither written nor change the known state. */
+
 template <typename T>
-void cadidaq::digitizer::programWrapper(void (caen::Digitizer::*write)(T), T (caen::Digitizer::*read)(), boost::optional<T> &value, comDirection direction){
+void cadidaq::digitizer::programWrapper(void (caen::Digitizer::*write)(T), T (caen::Digitizer::*read)(), boost::optional<T> &value, boost::optional<T> &known, comDirection direction){
   try{
     if (direction == comDirection::WRITING){
       // WRITING
-      if (value)
+      if (value){
+        if (known && *known == *value){
+          nElidedWrites++;
+          return;
+        }
         (dg->*write)(*value);
+        nWrites++;
+        known = value;
+      }
     } else {
       // READING
       value = (dg->*read)();
+      known = value;
     }
   }
   catch (caen::Error& e){
-    // TODO: more fine-grained error handling, more info on log
-    DG_LOG_ERROR << "Caught exception when communicating with digitizer " << dg->modelName() << ", serial " << dg->serialNumber() << ":";
-    if (direction == comDirection::WRITING)
-      DG_LOG_ERROR << "\t Calling " << e.where() << " with argument '" << std::to_string(*value) << "' caused exception: " << e.what();
-    else
-      DG_LOG_ERROR << "\t Calling " << e.where() << " caused exception: " << e.what();
+    recordError(e, [&](){
+        return direction == comDirection::WRITING ? "argument '" + std::to_string(*value) + "'" : std::string("reading");
+      });
     // setting assumed to be invalid regardless whether we read or write it:
     value = boost::none;
+    known = boost::none;
   }
 }
 
 template <typename T, typename C>
-void cadidaq::digitizer::programWrapper(void (caen::Digitizer::*write)(C, T), T (caen::Digitizer::*read)(C), C channel, boost::optional<T> &value, comDirection direction){
+void cadidaq::digitizer::programWrapper(void (caen::Digitizer::*write)(C, T), T (caen::Digitizer::*read)(C), C channel, boost::optional<T> &value, boost::optional<T> &known, comDirection direction){
   try{
     if (direction == comDirection::WRITING){
       // WRITING
-      if (value)
+      if (value){
+        if (known && *known == *value){
+          nElidedWrites++;
+          return;
+        }
         (dg->*write)(channel, *value);
+        nWrites++;
+        known = value;
+      }
     } else {
       // READING
       value = (dg->*read)(channel);
+      known = value;
     }
   }
   catch (caen::Error& e){
-    // TODO: more fine-grained error handling, more info on log
-    DG_LOG_ERROR << "Caught exception when communicating with digitizer " << dg->modelName() << ", serial " << dg->serialNumber() << ":";
-    if (direction == comDirection::WRITING)
-      DG_LOG_ERROR << "\t Calling " << e.where() << " for channel/group " << channel << " with argument '" << std::to_string(*value) << "' caused exception: " << e.what();
-    else
-      DG_LOG_ERROR << "\t Calling " << e.where() << " for channel/group " << channel << " caused exception: " << e.what();
+    recordError(e, [&](){
+        return "channel/group " + std::to_string(channel) + (direction == comDirection::WRITING ? ", argument '" + std::to_string(*value) + "'" : std::string(", reading"));
+      });
     // setting assumed to be invalid regardless whether we read or write it:
     value = boost::none;
+    known = boost::none;
   }
 }
 
 template <typename T1, typename T2>
-void cadidaq::digitizer::programWrapper(void (caen::Digitizer::*write)(T1, T2), void (caen::Digitizer::*read)(T1&, T2&), boost::optional<T1> &value1, boost::optional<T2> &value2, comDirection direction){
+void cadidaq::digitizer::programWrapper(void (caen::Digitizer::*write)(T1, T2), void (caen::Digitizer::*read)(T1&, T2&), boost::optional<T1> &value1, boost::optional<T2> &value2, boost::optional<T1> &known1, boost::optional<T2> &known2, comDirection direction){
   try{
     if (direction == comDirection::WRITING){
       // WRITING
-      if (value1 && value2)
+      if (value1 && value2){
+        if (known1 && known2 && *known1 == *value1 && *known2 == *value2){
+          nElidedWrites++;
+          return;
+        }
         (dg->*write)(*value1, *value2);
+        nWrites++;
+        known1 = value1;
+        known2 = value2;
+      }
     } else {
       // READING
       T1 v1;
       T2 v2;
       (dg->*read)(v1, v2);
-      value1 = v1;
-      value2 = v2;
+      value1 = known1 = v1;
+      value2 = known2 = v2;
     }
   }
   catch (caen::Error& e){
-    // TODO: more fine-grained error handling, more info on log
-    DG_LOG_ERROR << "Caught exception when communicating with digitizer " << dg->modelName() << ", serial " << dg->serialNumber() << ":";
-    if (direction == comDirection::WRITING)
-      DG_LOG_ERROR << "\t Calling " << e.where() << " with arguments '" << std::to_string(*value1) << "', '" << std::to_string(*value2) << "' caused exception: " << e.what();
-    else
-      DG_LOG_ERROR << "\t Calling " << e.where() << " caused exception: " << e.what();
+    recordError(e, [&](){
+        return direction == comDirection::WRITING ? "arguments '" + std::to_string(*value1) + "', '" + std::to_string(*value2) + "'" : std::string("reading");
+      });
     // setting assumed to be invalid regardless whether we read or write it:
     value1 = boost::none;
     value2 = boost::none;
+    known1 = boost::none;
+    known2 = boost::none;
   }
 }
 
-void cadidaq::digitizer::programMaskWrapper(void (caen::Digitizer::*write)(uint32_t), uint32_t (caen::Digitizer::*read)(), cadidaq::settingsBase::optionVector<bool> &vec, comDirection direction){
+void cadidaq::digitizer::programMaskWrapper(void (caen::Digitizer::*write)(uint32_t), uint32_t (caen::Digitizer::*read)(), cadidaq::settingsBase::optionVector<bool> &vec, cadidaq::settingsBase::optionVector<bool> &known, comDirection direction){
+  // the device masks either channels or groups of channels
+  uint groupSize = info.groups > 1 ? std::max<uint32_t>(info.channelsPerGroup, 1) : 1;
   boost::optional<uint32_t> mask = 0;
+  boost::optional<uint32_t> knownMask;
   // derive the mask in case we are writing it
   if (direction == comDirection::WRITING){
     // check if the setting has been configured at all
     if (countSet(vec.first) == 0)
       return; // keep the default
-    mask = vec2Mask(vec.first, dg->groups());
+    uint64_t groupMask = vec2Mask(vec.first, groupSize);
+    if (groupMask >> 32)
+      DG_LOG_WARN << "Setting '" << vec.second << "' enables channels beyond the 32 bit mask of the device '" << info.model << "', ignoring those.";
+    mask = static_cast<uint32_t>(groupMask);
     // verify that channel vector -> group mask conversion is consistent and the same as channel -> channel mask, else warn about misconfiguration
-    if (vec2Mask(vec.first, 1, dg->channelsPerGroup()) != vec2Mask(vec.first, 1, 1)){
-      DG_LOG_WARN << "Channel mask cannot be exactly mapped to groups of the device '"<< dg->modelName() << "' for setting '" << vec.second << "'. Using instead group mask of " << mask;
+    if (expandMask(groupMask, groupSize) != vec2Mask(vec.first)){
+      DG_LOG_WARN << "Channel mask cannot be exactly mapped to groups of the device '"<< info.model << "' for setting '" << vec.second << "'. Using instead group mask of " << mask;
     }
+    // the mask is only known if the state of every channel is
+    if (allValuesSet(known.first))
+      knownMask = static_cast<uint32_t>(vec2Mask(known.first, groupSize));
   }
-  programWrapper(write, read, mask, direction);
+  programWrapper(write, read, mask, knownMask, direction);
+  // store the mask now known to be on the device (or invalidate the known state)
+  mask2Vec(knownMask ? boost::optional<uint64_t>(*knownMask) : boost::none, known.first, groupSize);
   // if reading: now store the retrieved mask it in the vector
   if (direction == comDirection::READING)
-    mask2Vec(mask, vec.first, dg->groups());
+    mask2Vec(mask ? boost::optional<uint64_t>(*mask) : boost::none, vec.first, groupSize);
 }
 
 
-template <typename T, typename C>
-void cadidaq::digitizer::programLoopWrapper(void (caen::Digitizer::*write)(C, T), T (caen::Digitizer::*read)(C), cadidaq::settingsBase::optionVector<T> &vec, comDirection direction, bool ignoreGroups = false){
-  int ngroups = dg->groups();
-  // if groups are to be ignored
-  if (ignoreGroups)
-    ngroups = 1;
-  // verify that the vector can be put into group structure of the device (if channels are grouped)
-  if (ngroups>1){
-    for (int i = 0; i<ngroups; i++){
-      if (!allValuesSame(vec.first,i*dg->channelsPerGroup(), (i+1)*dg->channelsPerGroup()))
-        DG_LOG_WARN << "The channels in the range " << i*dg->channelsPerGroup() << " and " << (i+1)*dg->channelsPerGroup() << " for '" << vec.second << "' are set to different values -> cannot consistently convert to groups supported by the device!";
-    }
+/// a unit of channels programmed through a single call (a group of channels or a single channel)
+template <typename T>
+struct channelGroup {
+  std::size_t        first;      ///< first channel in the group
+  std::size_t        last;       ///< one past the last channel in the group
+  boost::optional<T> value;      ///< value to program: first value set in the group
+  boost::optional<T> known;      ///< known device state, only set if identical for all channels in the group
+  bool               consistent; ///< whether all set values in the group are identical
+};
+
+/// computes the group-collapsed programming plan of a channel vector and its known device state in a single pass
+template <typename T>
+static std::vector<channelGroup<T>> planChannelGroups(const cadidaq::channelVector<T>& vec, const cadidaq::channelVector<T>& known, std::size_t channelsPerGroup){
+  std::vector<channelGroup<T>> plan;
+  plan.reserve((vec.size() + channelsPerGroup - 1)/channelsPerGroup);
+  for (std::size_t first = 0; first < vec.size(); first += channelsPerGroup){
+    channelGroup<T> g;
+    g.first = first;
+    g.last = std::min(first + channelsPerGroup, vec.size());
+    g.value = getFirstSetValue(vec, first, g.last);
+    g.consistent = vec.allSame(first, g.last);
+    // the group's state is only known if all of its channels are known to hold the same value
+    g.known = known[first];
+    if (known.countSet(first, g.last) != (g.known ? g.last - first : 0) || !known.allSame(first, g.last))
+      g.known = boost::none;
+    plan.push_back(g);
   }
-  // loop over vector's entries and READ/WRITE values from/to digitzer
-  for (auto it = vec.first.begin(); it != vec.first.end(); ++it) {
-    auto channel = std::distance(vec.first.begin(), it);
+  return plan;
+}
+
+/** Reads/writes a per-channel setting with exactly one call per group of channels (or per channel if the device does
+    not group channels or ignoreGroups is set). */
+template <typename T, typename C>
+void cadidaq::digitizer::programLoopWrapper(void (caen::Digitizer::*write)(C, T), T (caen::Digitizer::*read)(C), cadidaq::settingsBase::optionVector<T> &vec, cadidaq::settingsBase::optionVector<T> &known, comDirection direction, bool ignoreGroups){
+  std::size_t channelsPerGroup = ignoreGroups ? 1 : std::max<uint32_t>(info.channelsPerGroup, 1);
+  auto plan = planChannelGroups(vec.first, known.first, channelsPerGroup);
+  for (auto& g : plan){
+    C group = g.first/channelsPerGroup;
     if (direction == comDirection::WRITING){
-      if (!*it)
+      if (!g.value)
         continue; // skip and leave default
+      // verify that the vector can be put into group structure of the device (if channels are grouped)
+      if (!g.consistent)
+        DG_LOG_WARN << "The channels in the range " << g.first << " and " << g.last << " for '" << vec.second << "' are set to different values -> cannot consistently convert to groups supported by the device! Using the value of the first channel set.";
     }
-    // map channel number to group index (or set to one if NGroups==1)
-    C group = channel/ngroups;
-    if (direction == comDirection::READING && channel%ngroups != 0)
-      continue; // only read once per group
-
     // perform the call to the digitizer
-    programWrapper(write, read, group, *it, direction);
-    if (direction == comDirection::READING){
-      if (ngroups > 1){
-        // set the other values in the group
-        for (int i = group*dg->channelsPerGroup(); i<(group+1)*dg->channelsPerGroup(); i++){
-          vec.first.at(i) = *it;
-        }
-      }
+    programWrapper(write, read, group, g.value, g.known, direction);
+    // the call affected all channels in the group: update their known state (and their values if reading or if the call failed)
+    for (std::size_t i = g.first; i < g.last; i++){
+      known.first.assign(i, g.known);
+      if (direction == comDirection::READING || !g.value)
+        vec.first.assign(i, g.value);
     }
   }
 }
 
-/** Implements checks on the configuration options.
-    This should take into account all 'Note:' parts of the CAEN digitizer library documentation for the supported models/FW versions. */
-void cadidaq::digitizer::verifySettings(){
-  // TODO: Trigger Polarity: channel parameter is unused (i.e. the setting is common to all channels) for those digitizers that do not support the individual trigger polarity setting. Please refer to the Registers Description document of the relevant board for check
-  // TODO: Trigger Polarity: not for DPP FW
-  // TODO: ChannelTriggerThreshold not for DPP FW (inform about alternative setting)
-  // TODO: MaxNumEventsBLT: if using DPP-PHA, DPP-PSD or DPP-CI firmware, you have to refer to the SetDPPEventAggregation function.
-  // TOOD: options specific to one model should not be set if we are using one without that function
+/// whether a row of the setting table applies to the connected device
+bool cadidaq::digitizer::inScope(cadidaq::settingScope scope){
+  switch (scope){
+  case settingScope::STANDARD: return !info.hasDppFw;
+  case settingScope::DPP:      return info.hasDppFw;
+  case settingScope::X751:     return info.is751Family;
+  default:                     return true;
+  }
 }
 
-/** Implements model/FW-specific settings verification and the calls mapping read/write methods from/to the digitizer and the corresponding the settings.
+template <typename S, typename WC, typename RC, typename WG, typename RG>
+void cadidaq::digitizer::programTableSetting(accessTag<cadidaq::settingAccess::COMMON>, WC writeChannel, RC readChannel, WG, RG, S &setting, S &known, comDirection direction){
+  programWrapper(writeChannel, readChannel, setting.first, known.first, direction);
+}
 
- */
-void cadidaq::digitizer::programSettings(comDirection direction){
+template <typename S, typename WC, typename RC, typename WG, typename RG>
+void cadidaq::digitizer::programTableSetting(accessTag<cadidaq::settingAccess::CHANNELS>, WC writeChannel, RC readChannel, WG writeGroup, RG readGroup, S &setting, S &known, comDirection direction){
+  // settings differ for devices with grouped/ungrouped channels
+  if (info.groups == 1)
+    programLoopWrapper(writeChannel, readChannel, setting, known, direction);
+  else
+    programLoopWrapper(writeGroup, readGroup, setting, known, direction);
+}
 
-  /* data readout */
-  if (!dg->hasDppFw()){
-    // maxNumEventsBLT only for non-DPP FW, DPP uses SetDPPEventAggregation
-    programWrapper(&caen::Digitizer::setMaxNumEventsBLT, &caen::Digitizer::getMaxNumEventsBLT, reg->maxNumEventsBLT.first, direction);
-  }
+template <typename S, typename WC, typename RC, typename WG, typename RG>
+void cadidaq::digitizer::programTableSetting(accessTag<cadidaq::settingAccess::EACH_CHANNEL>, WC writeChannel, RC readChannel, WG, RG, S &setting, S &known, comDirection direction){
+  programLoopWrapper(writeChannel, readChannel, setting, known, direction, true);
+}
 
-  /* trigger */
-  programWrapper(&caen::Digitizer::setSWTriggerMode, &caen::Digitizer::getSWTriggerMode, reg->swTriggerMode.first, direction);
-  programWrapper(&caen::Digitizer::setExternalTriggerMode, &caen::Digitizer::getExternalTriggerMode, reg->externalTriggerMode.first, direction);
-  programWrapper(&caen::Digitizer::setIOlevel, &caen::Digitizer::getIOlevel, reg->ioLevel.first, direction);
-  programWrapper(&caen::Digitizer::setRunSynchronizationMode, &caen::Digitizer::getRunSynchronizationMode, reg->runSyncMode.first, direction);
-  programWrapper(&caen::Digitizer::setOutputSignalMode, &caen::Digitizer::getOutputSignalMode, reg->outSignalMode.first, direction);
-  if (!dg->hasDppFw()){
-    // Standard FW only
-
-    // NOTE: Trigger Polarity: channel parameter is unused (i.e. the setting is common to all channels) for those digitizers that do not support the individual trigger polarity setting. Please refer to the Registers Description document of the relevant board for check
-    programLoopWrapper(&caen::Digitizer::setTriggerPolarity, &caen::Digitizer::getTriggerPolarity, reg->chTriggerPolarity, direction);
-    // settings different to devices with grouped/ungrouped channels
-    if (dg->groups() == 1){
-      // no grouped channels
-      programLoopWrapper(&caen::Digitizer::setChannelTriggerThreshold, &caen::Digitizer::getChannelTriggerThreshold, reg->chTriggerThreshold, direction);
-    } else {
-      // channels are grouped
-      programLoopWrapper(&caen::Digitizer::setGroupTriggerThreshold, &caen::Digitizer::getGroupTriggerThreshold, reg->chTriggerThreshold, direction);
+template <typename S, typename WC, typename RC, typename WG, typename RG>
+void cadidaq::digitizer::programTableSetting(accessTag<cadidaq::settingAccess::MASK>, WC writeChannel, RC readChannel, WG writeGroup, RG readGroup, S &setting, S &known, comDirection direction){
+  if (info.groups == 1)
+    programMaskWrapper(writeChannel, readChannel, setting, known, direction);
+  else
+    programMaskWrapper(writeGroup, readGroup, setting, known, direction);
+}
+
+/** Reads or writes the configured address-value pairs.
+    When writing, the pairs are written one by one in the order of the configuration, where immediately repeated
+    writes of the same value to the same address are merged into one. As the registers may hold any of the settings
+    programmed through the library, they are written again whenever rewrite is set, even if they are known to be on
+    the device. */
+void cadidaq::digitizer::programRegisters(comDirection direction, bool rewrite){
+  if (direction == comDirection::READING){
+    for (auto& r:reg->registerValues){
+      try{
+        r.second = dg->readRegister(r.first);
+      }
+      catch (caen::Error& e){
+        recordError(e, [&](){ return "address '" + hex2str(r.first) + "', reading"; });
+      }
     }
-  } else {
-    // DPP FW only
-    
-  } // hasDPP
-  // Standard FW and DPP, either grouped or non-grouped channels:
-  if (dg->groups() == 1){
-    // no grouped channels
-    // TODO: find out whether or not to call this with DPP FW present! Documentation not 100% clear on that.. (use DPPParams.selft = ... instead?)
-    programLoopWrapper(&caen::Digitizer::setChannelSelfTrigger, &caen::Digitizer::getChannelSelfTrigger, reg->chSelfTrigger, direction);
-  } else {
-    // channels are grouped
-    // TODO: find out whether or not to call this with DPP FW present! Documentation not 100% clear on that.. (use DPPParams.selft = ... instead?)
-    programLoopWrapper(&caen::Digitizer::setGroupSelfTrigger, &caen::Digitizer::getGroupSelfTrigger, reg->chSelfTrigger, direction);
+    return;
   }
 
-  /* acquisition */
-  // setRecordLength requires subsequent call to SetPostTriggerSize
-  programWrapper(&caen::Digitizer::setAcquisitionMode, &caen::Digitizer::getAcquisitionMode, reg->acquisitionMode.first, direction);
-  programWrapper(&caen::Digitizer::setRecordLength, &caen::Digitizer::getRecordLength, reg->recordLength.first, direction);
-  programWrapper(&caen::Digitizer::setPostTriggerSize, &caen::Digitizer::getPostTriggerSize, reg->postTriggerSize.first, direction);
-  if (dg->groups() == 1){
-    // no grouped channels
-    programMaskWrapper(&caen::Digitizer::setChannelEnableMask, &caen::Digitizer::getChannelEnableMask, reg->chEnable, direction);
-    programLoopWrapper(&caen::Digitizer::setChannelDCOffset, &caen::Digitizer::getChannelDCOffset, reg->chDCOffset, direction);
-  } else {
-    // channels are grouped
-    programMaskWrapper(&caen::Digitizer::setGroupEnableMask, &caen::Digitizer::getGroupEnableMask, reg->chEnable, direction);
-    // NOTE: GroupDCOffset: from AMC FPGA firmware release 0.10 on, it is possible to apply an 8-bit positive digital offset individually to each channel inside a group of the x740 digitizer to finely correct the baseline mismatch. This function is not supported by the CAENdigitizer library, but the user can refer the registers documentation.
-    programLoopWrapper(&caen::Digitizer::setGroupDCOffset, &caen::Digitizer::getGroupDCOffset, reg->chDCOffset, direction);
+  if (reg->registerValues.empty())
+    return;
+  if (!rewrite){
+    nElidedWrites += reg->registerValues.size();
+    DG_LOG_DEBUG << "Skipped " << reg->registerValues.size() << " register value(s) already on the device";
+    return;
   }
-  // X751-family specific settings
-  if (dg->is751Family()){
-    programWrapper(&caen::Digitizer::setDESMode, &caen::Digitizer::getDESMode, reg->desMode.first, direction);
+  uint64_t nMergedBefore = nMergedWrites;
+  bool failed = false;
+  const std::pair<uint32_t, uint32_t>* previous = nullptr;
+  for (auto& r:reg->registerValues){
+    if (previous && *previous == r){
+      nMergedWrites++;
+      continue;
+    }
+    previous = &r;
+    try{
+      dg->writeRegister(r.first, r.second);
+      nWrites++;
+    }
+    catch (caen::Error& e){
+      recordError(e, [&](){ return "address '" + hex2str(r.first) + "', value '" + hex2str(r.second) + "'"; });
+      failed = true;
+    }
   }
+  // what a failed write left on the device is unknown
+  if (failed)
+    forgetDeviceState();
+  else
+    shadow->registerValues = reg->registerValues;
+  DG_LOG_DEBUG << "Programmed " << reg->registerValues.size() << " register value(s), " << nMergedWrites - nMergedBefore << " repeated write(s) merged";
+}
 
-  // DPP - FW
-  if (dg->hasDppFw()){
-    // NOTE: loop wrapper is called with ignoreGroups = true as the DPP options are set channel-by-channel in contrast to the non-DPP channel options
-    if (dg->isDppCiFw()){
+/** Programs the rows of the setting table with settingAccess::CUSTOM, identified by their member of reg. */
+void cadidaq::digitizer::programCustomSetting(const void* setting, comDirection direction){
+  if (setting == &reg->dppPreTriggerSize){
+    if (info.isDppCiFw){
       // DPP-CI only supports ch= -1 (different channels must have the same pre-trigger)
       if (!allValuesSame(reg->dppPreTriggerSize.first)){
         DG_LOG_WARN << "Firmware only supports same pre-trigger for all channels but " << reg->dppPreTriggerSize.second << " not set to same value for all channels. Will apply value given for first channel to all.";
       }
-      programWrapper(&caen::Digitizer::setDPPPreTriggerSize, &caen::Digitizer::getDPPPreTriggerSize, -1, reg->dppPreTriggerSize.first.at(0), direction);
+      boost::optional<uint32_t> preTrigger = reg->dppPreTriggerSize.first[0];
+      boost::optional<uint32_t> knownPreTrigger = shadow->dppPreTriggerSize.first[0];
+      programWrapper(&caen::Digitizer::setDPPPreTriggerSize, &caen::Digitizer::getDPPPreTriggerSize, -1, preTrigger, knownPreTrigger, direction);
       // set other elements in the vector to same value for consistency
-      std::fill(reg->dppPreTriggerSize.first.begin(), reg->dppPreTriggerSize.first.end(), reg->dppPreTriggerSize.first.at(0));
+      reg->dppPreTriggerSize.first.fill(preTrigger);
+      shadow->dppPreTriggerSize.first.fill(knownPreTrigger);
     } else {
-      programLoopWrapper(&caen::Digitizer::setDPPPreTriggerSize, &caen::Digitizer::getDPPPreTriggerSize, reg->dppPreTriggerSize, direction, true);
+      programLoopWrapper(&caen::Digitizer::setDPPPreTriggerSize, &caen::Digitizer::getDPPPreTriggerSize, reg->dppPreTriggerSize, shadow->dppPreTriggerSize, direction, true);
     }
-    programLoopWrapper(&caen::Digitizer::setChannelPulsePolarity, &caen::Digitizer::getChannelPulsePolarity, reg->dppChPulsePolarity, direction, true);
-    programWrapper(&caen::Digitizer::setDPPAcquisitionMode, &caen::Digitizer::getDPPAcquisitionMode, reg->dppAcqMode.first, reg->dppAcqModeParam.first, direction);
-    programWrapper(&caen::Digitizer::setDPPTriggerMode, &caen::Digitizer::getDPPTriggerMode, reg->dppTriggermode.first, direction);
   }
+  // mode and parameter are programmed together with the row of the mode
+  else if (setting == &reg->dppAcqMode)
+    programWrapper(&caen::Digitizer::setDPPAcquisitionMode, &caen::Digitizer::getDPPAcquisitionMode, reg->dppAcqMode.first, reg->dppAcqModeParam.first, shadow->dppAcqMode.first, shadow->dppAcqModeParam.first, direction);
+}
 
-  /* program address-value pairs configured individually */
-  for (auto r:reg->registerValues){
-    try{
-      dg->writeRegister(r.first, r.second);
-    }
-    catch (caen::Error& e){
-      DG_LOG_ERROR << "Caught exception when communicating with digitizer " << dg->modelName() << ", serial " << dg->serialNumber() << ":";
-      DG_LOG_ERROR << "\t Calling " << e.where() << " for address '" << hex2str(r.first) << "' and value '" <<  hex2str(r.second) << "' caused exception: " << e.what();
-    }
+/** Forgets everything known about the device state, so that all settings are written again. */
+void cadidaq::digitizer::forgetDeviceState(){
+  delete shadow;
+  shadow = new cadidaq::registerSettings(name, info.channels);
+}
+
+/** Forgets the known device state of the settings which the device changes (or requires to be written again) when
+    the given member of reg has been written, so that the rows following it in the setting table are written again. */
+void cadidaq::digitizer::forgetDependentSettings(const void* setting){
+  // SetRecordLength requires a subsequent call to SetPostTriggerSize
+  if (setting == &reg->recordLength)
+    shadow->postTriggerSize.first = boost::none;
+}
+
+/** Implements checks on the configuration options.
+    This should take into account all 'Note:' parts of the CAEN digitizer library documentation for the supported models/FW versions. */
+void cadidaq::digitizer::verifySettings(){
+  // TODO: Trigger Polarity: channel parameter is unused (i.e. the setting is common to all channels) for those digitizers that do not support the individual trigger polarity setting. Please refer to the Registers Description document of the relevant board for check
+  // TODO: Trigger Polarity: not for DPP FW
+  // TODO: ChannelTriggerThreshold not for DPP FW (inform about alternative setting)
+  // TODO: MaxNumEventsBLT: if using DPP-PHA, DPP-PSD or DPP-CI firmware, you have to refer to the SetDPPEventAggregation function.
+  // TOOD: options specific to one model should not be set if we are using one without that function
+}
+
+/** Implements model/FW-specific settings verification and the calls mapping read/write methods from/to the digitizer and the corresponding the settings.
+
+ */
+void cadidaq::digitizer::programSettings(comDirection direction){
+  uint64_t nWritesBefore = nWrites;
+  uint64_t nElidedBefore = nElidedWrites;
+  uint64_t nMergedBefore = nMergedWrites;
+
+  /* raw register writes may have changed any of the settings: once they differ from the ones last written, nothing
+     written before through the library is known to be on the device any more */
+  bool rawChanged = reg->registerValues != shadow->registerValues;
+  if (direction == comDirection::WRITING && rawChanged && !shadow->registerValues.empty())
+    forgetDeviceState();
+
+  /* all settings from the setting table, in table order */
+#define CADIDAQ_PROGRAM_SETTING(CONTAINER, TYPE, MEMBER, KEY, FORMAT, SCOPE, ACCESS, CHANNEL, GROUP) \
+  if (inScope(settingScope::SCOPE)){                                                                \
+    uint64_t nWritesRow = nWrites;                                                                  \
+    programTableSetting(accessTag<settingAccess::ACCESS>(),                                         \
+                        &caen::Digitizer::set##CHANNEL, &caen::Digitizer::get##CHANNEL,             \
+                        &caen::Digitizer::set##GROUP, &caen::Digitizer::get##GROUP,                 \
+                        reg->MEMBER, shadow->MEMBER, direction);                                    \
+    if (nWrites != nWritesRow)                                                                      \
+      forgetDependentSettings(&reg->MEMBER);                                                        \
   }
+  CADIDAQ_REGISTER_SETTINGS(CADIDAQ_PROGRAM_SETTING)
+#undef CADIDAQ_PROGRAM_SETTING
+
+  /* program address-value pairs configured individually, again if any write above may have overwritten them */
+  programRegisters(direction, rawChanged || nWrites != nWritesBefore);
+  reportErrors(direction);
+  if (direction == comDirection::WRITING)
+    DG_LOG_INFO << "Programmed settings with " << nWrites - nWritesBefore << " write(s), skipped " << nElidedWrites - nElidedBefore << " write(s) of values already on the device, merged " << nMergedWrites - nMergedBefore << " repeated raw register write(s)";
 }
@@ -0,0 +1,67 @@
+#include <eventDecoder.hpp>
+
+#include <algorithm>
+
+#include <digitizer.hpp> // boardInfo
+#include <settings.hpp>
+#include <helper.hpp>    // vec2Mask, parseInteger
+
+cadidaq::standardDecoder::standardDecoder(const cadidaq::boardInfo& info, uint32_t channelMask, uint32_t recordLength)
+  : channelsPerBlock(1), checkLayout(true), expectedMask(channelMask), nEvents(0), nCorrupt(0), nUnexpected(0){
+  if (info.is751Family || info.adcBits == 10){
+    layout = sampleLayout::TRIPLETS;
+    sampleMask = 0x3FF;
+    expectedBlockWords = (recordLength + 2)/3;
+  } else if (info.groups > 1){
+    layout = sampleLayout::GROUP_12;
+    sampleMask = 0xFFF;
+    channelsPerBlock = std::max<uint32_t>(info.channelsPerGroup, 1);
+    expectedBlockWords = (recordLength + 2)/3*9;
+  } else {
+    layout = sampleLayout::PAIRS;
+    sampleMask = (1u << std::min<uint32_t>(std::max<uint32_t>(info.adcBits, 1), 14)) - 1;
+    expectedBlockWords = (recordLength + 1)/2;
+  }
+}
+
+cadidaq::standardDecoder::standardDecoder(const cadidaq::boardInfo& info, const cadidaq::registerSettings& settings)
+  : standardDecoder(info, (uint32_t)vec2Mask(settings.chEnable.first, info.groups > 1 ? std::max<uint32_t>(info.channelsPerGroup, 1) : 1),
+                    settings.recordLength.first.get_value_or(0)){
+  checkLayout = settings.recordLength.first && allValuesSet(settings.chEnable.first);
+}
+
+/// major number of the AMC firmware release ("<major>.<minor>"), which identifies the DPP firmware; 0 if unknown
+static uint32_t amcMajor(const cadidaq::boardInfo& info){
+  const char* begin = info.amcFirmware.data();
+  const char* end = begin + info.amcFirmware.size();
+  uint32_t major = 0;
+  if (!parseInteger(begin, std::find(begin, end, '.'), major))
+    return 0;
+  return major;
+}
+
+// AMC firmware codes of the DPP firmwares decoded by dppDecoder
+static const uint32_t dppPha724 = 128, dppPsd720 = 131, dppPsd751 = 132, dppPsd730 = 136, dppPha730 = 139;
+
+bool cadidaq::dppDecoder::supports(const cadidaq::boardInfo& info){
+  uint32_t major = amcMajor(info);
+  return info.hasDppFw && (major == dppPha724 || major == dppPsd720 || major == dppPsd751 || major == dppPsd730 || major == dppPha730);
+}
+
+cadidaq::dppDecoder::dppDecoder(const cadidaq::boardInfo& info, CAEN_DGTZ_DPP_SaveParam_t saveParam, CAEN_DGTZ_DPP_AcqMode_t acqMode)
+  : checkFormat(true), nHits(0), nCorrupt(0), nUnexpected(0){
+  uint32_t major = amcMajor(info);
+  isPsd = major != dppPha724 && major != dppPha730;
+  // the x725/x730 firmwares aggregate the hits of pairs of channels
+  channelsPerAggregate = (major == dppPsd730 || major == dppPha730) ? 2 : 1;
+  sampleMask = (1u << std::min<uint32_t>(std::max<uint32_t>(info.adcBits, 1), 14)) - 1;
+  reportTime = saveParam == CAEN_DGTZ_DPP_SAVE_PARAM_TimeOnly || saveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime;
+  reportEnergy = saveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyOnly || saveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime;
+  expectedFormat = (reportEnergy ? 1u << 30 : 0) | (reportTime ? 1u << 29 : 0) | (acqMode != CAEN_DGTZ_DPP_ACQ_MODE_List ? 1u << 27 : 0);
+}
+
+cadidaq::dppDecoder::dppDecoder(const cadidaq::boardInfo& info, const cadidaq::registerSettings& settings)
+  : dppDecoder(info, settings.dppAcqModeParam.first.get_value_or(CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime),
+               settings.dppAcqMode.first.get_value_or(CAEN_DGTZ_DPP_ACQ_MODE_List)){
+  checkFormat = settings.dppAcqModeParam.first && settings.dppAcqMode.first;
+}
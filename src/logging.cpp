@@ -7,11 +7,22 @@
 #include <boost/log/attributes/attribute_cast.hpp>
 #include <boost/log/attributes/attribute_value.hpp>
 #include <boost/log/attributes/constant.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
 // BOOST time formatting
 #include <boost/log/support/date_time.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <cstdlib>
+
 #include <logging.hpp>
+#include <mpscRing.hpp>
 
 // Define the attribute keywords
 BOOST_LOG_ATTRIBUTE_KEYWORD(line_id, "LineID", unsigned int)
@@ -64,9 +75,88 @@ void coloring_formatter_terminate(const logging::record_view& record,
   stream << "\e[0m";
 }
 
-void init_console_logging(){
-  // init BOOST logging
-  boost::log::add_common_attributes();
+/** /class logRecordQueue
+    Queueing strategy for boost's asynchronous sink frontend using a bounded
+    lock-free ring: the logging threads only filter and enqueue records while
+    formatting and writing to the console happens on the sink's own thread.
+    When the ring is full, records are either dropped (and counted) or the
+    logging thread waits for the formatting thread to catch up.
+ */
+class logRecordQueue {
+public:
+  /// has to be called before the sink is added to the logging core
+  void configureQueue(std::size_t capacity, bool dropOnOverflow){
+    ring.reset(new cadidaq::mpscRing<logging::record_view>(capacity));
+    drop = dropOnOverflow;
+  }
+  uint64_t droppedRecords() const {return nDropped.load(std::memory_order_relaxed);}
+  std::size_t queueCapacity() const {return ring ? ring->capacity() : 0;}
+
+protected:
+  logRecordQueue() : drop(true), nDropped(0), interrupted(false) {}
+  template <typename ArgsT>
+  explicit logRecordQueue(ArgsT const&) : drop(true), nDropped(0), interrupted(false) {}
+
+  void enqueue(logging::record_view const& rec){
+    if (ring->push(rec))
+      return;
+    if (drop){
+      nDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    while (!ring->push(rec))
+      std::this_thread::yield();
+  }
+
+  bool try_enqueue(logging::record_view const& rec){
+    return ring->push(rec);
+  }
+
+  bool try_dequeue_ready(logging::record_view& rec){
+    return ring->pop(rec);
+  }
+
+  bool try_dequeue(logging::record_view& rec){
+    return ring->pop(rec);
+  }
+
+  /// waits for a record; returns false if interrupted before one arrived
+  bool dequeue_ready(logging::record_view& rec){
+    unsigned int idle = 0;
+    while (true){
+      if (ring->pop(rec))
+        return true;
+      if (interrupted.exchange(false, std::memory_order_acquire))
+        return false;
+      // stay responsive during bursts, but do not burn a core while idle
+      if (++idle < 64)
+        std::this_thread::yield();
+      else
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  void interrupt_dequeue(){
+    interrupted.store(true, std::memory_order_release);
+  }
+
+private:
+  std::unique_ptr<cadidaq::mpscRing<logging::record_view>> ring;
+  bool                  drop;
+  std::atomic<uint64_t> nDropped;
+  std::atomic<bool>     interrupted;
+};
+
+typedef sinks::synchronous_sink< sinks::text_ostream_backend > syncConsoleSink;
+typedef sinks::asynchronous_sink< sinks::text_ostream_backend, logRecordQueue > asyncConsoleSink;
+
+static boost::shared_ptr< syncConsoleSink >  syncSink;
+static boost::shared_ptr< asyncConsoleSink > asyncSink;
+static std::thread                           asyncThread;
+/// set by the formatting thread once it left the sink's feeding loop
+static std::atomic<bool>                     asyncThreadDone(false);
+
+static logging::filter console_filter(){
   // Create a minimal severity table filter
   typedef boost::log::expressions::channel_severity_filter_actor< std::string, boost::log::trivial::severity_level > min_severity_filter;
   min_severity_filter min_severity = boost::log::expressions::channel_severity_filter(channel, severity);
@@ -75,21 +165,91 @@ void init_console_logging(){
   min_severity["cfg"] = boost::log::trivial::debug;
   min_severity["main"] = boost::log::trivial::debug;
   min_severity["dig"] = boost::log::trivial::debug;
+  min_severity["daq"] = boost::log::trivial::debug;
+
+  return min_severity || severity >= boost::log::trivial::fatal;
+}
+
+static logging::formatter console_formatter(){
+  return (
+          boost::log::expressions::stream
+          << expr::wrap_formatter(&coloring_formatter)
+          << line_id << " "
+          << expr::format_date_time< boost::posix_time::ptime >("TimeStamp", "%Y-%m-%d %H:%M:%S")
+          << ": <" << severity
+          << "> [" << channel << expr::wrap_formatter(&digitizer_formatter) << "] "
+          << boost::log::expressions::smessage
+          << expr::wrap_formatter(&coloring_formatter_terminate)
+          );
+}
 
-  auto consoleLog = boost::log::add_console_log(
-                  std::clog,
-                  boost::log::keywords::filter = min_severity || severity >= boost::log::trivial::fatal,
-                  boost::log::keywords::format =
-                  (
-                   boost::log::expressions::stream
-                   << expr::wrap_formatter(&coloring_formatter)
-                   << line_id << " "
-                   << expr::format_date_time< boost::posix_time::ptime >("TimeStamp", "%Y-%m-%d %H:%M:%S")
-                   << ": <" << severity
-                   << "> [" << channel << expr::wrap_formatter(&digitizer_formatter) << "] "
-                   << boost::log::expressions::smessage
-                   << expr::wrap_formatter(&coloring_formatter_terminate)
-                   )
-                  );
+static boost::shared_ptr< sinks::text_ostream_backend > console_backend(){
+  auto backend = boost::make_shared< sinks::text_ostream_backend >();
+  // std::clog is not owned by the backend
+  backend->add_stream(boost::shared_ptr< std::ostream >(&std::clog, [](std::ostream*){}));
+  return backend;
 }
 
+void init_console_logging(){
+  // init BOOST logging
+  boost::log::add_common_attributes();
+  syncSink = boost::make_shared< syncConsoleSink >(console_backend());
+  syncSink->set_filter(console_filter());
+  syncSink->set_formatter(console_formatter());
+  logging::core::get()->add_sink(syncSink);
+}
+
+void init_async_console_logging(std::size_t queueSize, bool dropOnOverflow){
+  if (asyncSink)
+    return;
+  // the sink's feeding thread is started by hand so the queue can be sized before any record arrives
+  asyncSink = boost::make_shared< asyncConsoleSink >(console_backend(), false);
+  asyncSink->configureQueue(queueSize, dropOnOverflow);
+  asyncSink->set_filter(console_filter());
+  asyncSink->set_formatter(console_formatter());
+  boost::shared_ptr< asyncConsoleSink > sink = asyncSink;
+  asyncThreadDone = false;
+  asyncThread = std::thread([sink](){
+    sink->run();
+    asyncThreadDone = true;
+  });
+  logging::core::get()->add_sink(asyncSink);
+  if (syncSink)
+    logging::core::get()->remove_sink(syncSink);
+  // make sure queued records are written also when leaving through exit()
+  static bool registered = false;
+  if (!registered){
+    std::atexit(stop_logging);
+    registered = true;
+  }
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::debug) << "Asynchronous console logging enabled (queue of "
+                                                                << asyncSink->queueCapacity() << " records, "
+                                                                << (dropOnOverflow ? "dropping" : "blocking") << " when full).";
+}
+
+void stop_logging(){
+  if (!asyncSink)
+    return;
+  // drain what is still queued, then hand the console back to the synchronous sink; stop() returns without effect
+  // while the formatting thread has not yet entered the feeding loop, so it is repeated until the thread is done
+  while (asyncThread.joinable() && !asyncThreadDone){
+    asyncSink->stop();
+    std::this_thread::yield();
+  }
+  if (asyncThread.joinable())
+    asyncThread.join();
+  asyncSink->flush();
+  if (syncSink)
+    logging::core::get()->add_sink(syncSink);
+  logging::core::get()->remove_sink(asyncSink);
+  // records which arrived while swapping sinks
+  asyncSink->flush();
+  uint64_t dropped = asyncSink->droppedRecords();
+  asyncSink.reset();
+  if (dropped > 0)
+    CADIDAQ_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::warning) << dropped << " log record(s) were dropped as the asynchronous logging queue was full.";
+}
+
+uint64_t dropped_log_records(){
+  return asyncSink ? asyncSink->droppedRecords() : 0;
+}
@@ -6,6 +6,11 @@
 #include <fstream>
 #include <iostream>
 #include <stdexcept> // exceptions
+#include <cstdlib>   // EXIT_FAILURE
+#include <csignal>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 #include <boost/property_tree/ini_parser.hpp>
 #include <boost/program_options.hpp>
@@ -15,6 +20,8 @@
 #include <logging.hpp>
 #include <settings.hpp>
 #include <digitizer.hpp>
+#include <readout.hpp>
+#include <configScheduler.hpp>
 
 #include <helper.hpp>       // CadiDAQ helper functions
 
@@ -22,22 +29,55 @@ namespace po = boost::program_options;
 namespace pt = boost::property_tree;
 
 #define MAIN_LOG_DEBUG                                          \
-  BOOST_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::debug)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::debug)
 #define MAIN_LOG_INFO                                           \
-  BOOST_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::info)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::info)
 #define MAIN_LOG_WARN                                             \
-  BOOST_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::warning)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::warning)
 #define MAIN_LOG_ERROR                                          \
-  BOOST_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::error)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::error)
 #define MAIN_LOG_FATAL                                          \
-  BOOST_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::fatal)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "main", boost::log::trivial::fatal)
 
 
+/// set by the signal handler to end the acquisition
+static std::atomic<bool> interrupted(false);
+
+void signal_handler(int /*signal*/){
+  interrupted = true;
+}
+
+//
+// running the acquisition
+//
+
+void run_daq(std::vector<cadidaq::digitizer*>& vecDigi, cadidaq::daqSettings& daqSettings){
+  if (!daqSettings.runDuration.first){
+    MAIN_LOG_INFO << "No '" << daqSettings.runDuration.second << "' set in [CADIDAQ] section, skipping acquisition.";
+    return;
+  }
+  uint32_t duration = *daqSettings.runDuration.first;
+  cadidaq::readout daq(vecDigi, &daqSettings);
+  std::signal(SIGINT, signal_handler);
+  daq.start();
+  if (duration > 0)
+    MAIN_LOG_INFO << "Acquiring data for " << duration << " s (press Ctrl-C to stop earlier).";
+  else
+    MAIN_LOG_INFO << "Acquiring data until interrupted (press Ctrl-C to stop).";
+  auto stopTime = std::chrono::steady_clock::now() + std::chrono::seconds(duration);
+  while (!interrupted && (duration == 0 || std::chrono::steady_clock::now() < stopTime))
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  daq.stop();
+  std::signal(SIGINT, SIG_DFL);
+  daq.printStatistics();
+}
+
 //
 // reading config file
 //
 
-void read_ini_file(const char *filename)
+/// configures the digitizers of the file and runs the acquisition; returns false if a digitizer could not be configured
+bool read_ini_file(const char *filename)
 {
 
     /* Open the UTF8 .ini file */
@@ -58,7 +98,24 @@ void read_ini_file(const char *filename)
     }
     MAIN_LOG_INFO << "Configuration for " << NDigitizer << " digitizer(s) found in config file.";
 
+    // parse the settings for the DAQ application itself
+    cadidaq::daqSettings daqSettings("CADIDAQ");
+    try {
+      pt::iptree &nodeDaq = iniPTree.get_child("CADIDAQ");
+      daqSettings.parse(&nodeDaq);
+      for (auto& key : nodeDaq){
+        MAIN_LOG_WARN << "Unknown setting in section CADIDAQ ignored: \t" << key.first << " = " << key.second.get_value<std::string>();
+      }
+    }
+    catch (const pt::ptree_bad_path& e){
+      MAIN_LOG_DEBUG << "No 'CADIDAQ' section found in config file, using defaults.";
+    }
+    daqSettings.verify();
+    if (*daqSettings.asyncLogging.first)
+      init_async_console_logging(*daqSettings.logQueueSize.first, *daqSettings.logDropOnOverflow.first);
+
     std::vector<cadidaq::digitizer*> vecDigi;
+    cadidaq::configScheduler scheduler;
     // get the connection details for each digitizer section
     for (auto& section : iniPTree){
       // ignoring "daq" settings for main application
@@ -92,14 +149,19 @@ void read_ini_file(const char *filename)
         node = &nodeDigi;
       }
 
-      // parse, establish connection and configure digitizer
+      // queue the digitizer for parsing, establishing the connection and configuring it
       cadidaq::digitizer* digi = new cadidaq::digitizer(digName);
-      digi->configure(node);
+      scheduler.add(digi, node);
       vecDigi.push_back(digi);
 
     }
+    if (!scheduler.run(*daqSettings.parallelConfiguration.first)){
+      MAIN_LOG_FATAL << "Could not configure all digitizers, giving up.";
+      return false;
+    }
 
-    // TODO: init and run the actual "DAQ" part of the application here
+    // run the actual "DAQ" part of the application
+    run_daq(vecDigi, daqSettings);
 
     // write the config back to another file
     std::string outIniFileName = "output.ini";
@@ -110,6 +172,7 @@ void read_ini_file(const char *filename)
       ptwrite.put_child(digi->getName(), *node);
     }
     pt::ini_parser::write_ini(outIniFileName, ptwrite);
+    return true;
 }
 
 
@@ -148,8 +211,12 @@ int main(int argc, char **argv)
 
     std::string iniFile = vm["file"].as<std::string>().c_str();
     std::cout << "Read ini file: " << iniFile << std::endl;
-    read_ini_file(iniFile.c_str());
+    if (!read_ini_file(iniFile.c_str())){
+      stop_logging();
+      return EXIT_FAILURE;
+    }
     MAIN_LOG_INFO << "Program loop terminated. Have a nice day :)";
+    stop_logging();
     return 0;
 }
 
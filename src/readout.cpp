@@ -0,0 +1,329 @@
+#include <readout.hpp>
+
+#include <string>
+#include <cstring> // strerror
+#include <cerrno>
+
+#ifdef __linux__
+#include <pthread.h> // pthread_setaffinity_np
+#endif
+
+// logging
+#include <boost/log/attributes/constant.hpp>
+
+#include <digitizer.hpp>
+#include <traceLog.hpp>
+
+#include <logLevel.hpp> // CADIDAQ_LOG_CHANNEL_SEV
+
+#define DAQ_LOG_DEBUG                                           \
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "daq", boost::log::trivial::debug)
+#define DAQ_LOG_INFO                                            \
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "daq", boost::log::trivial::info)
+#define DAQ_LOG_WARN                                              \
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "daq", boost::log::trivial::warning)
+#define DAQ_LOG_ERROR                                           \
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "daq", boost::log::trivial::error)
+#define DAQ_LOG_FATAL                                           \
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "daq", boost::log::trivial::fatal)
+
+/// number of consecutive failed transfers after which a board's readout is given up
+static const int maxConsecutiveErrors = 10;
+
+/// records waiting in each input of the time-ordered merge (a board, or a channel of a DPP firmware) beyond which the
+/// earliest ones are released before the merge window has passed
+static const std::size_t maxMergeQueue = 1 << 18;
+
+/// time covered by the time tags a decoder has seen, and their rollovers and late arrivals
+static std::string describeClock(const cadidaq::timestampExtender& clock, uint32_t tickPeriod){
+  return "time tags span " + std::to_string(clock.span()*1e-9*tickPeriod) + " s with " + std::to_string(clock.getRollovers())
+    + " rollover(s), " + std::to_string(clock.getLateTags()) + " late";
+}
+
+cadidaq::readout::readout(std::vector<cadidaq::digitizer*>& digitizers, cadidaq::daqSettings* settings) : consuming(false), settings(settings), merger(nullptr), running(false){
+  for (auto digi : digitizers){
+    board* b = new board();
+    b->digi = digi;
+    b->decoder = nullptr;
+    b->hitDecoder = nullptr;
+    b->index = boards.size();
+    b->firstInput = 0;
+    b->untimedHits = 0;
+    b->filled = new bufferRing(*settings->readoutBuffers.first);
+    b->free = new bufferRing(*settings->readoutBuffers.first);
+    b->transfers = 0;
+    b->bytes = 0;
+    b->events = 0;
+    b->errors = 0;
+    b->droppedTransfers = 0;
+    b->droppedEvents = 0;
+    boards.push_back(b);
+  }
+}
+
+cadidaq::readout::~readout(){
+  stop();
+  for (auto b : boards){
+    for (auto& buffer : b->buffers)
+      b->digi->freeBuffer(buffer);
+    delete b->decoder;
+    delete b->hitDecoder;
+    delete b->filled;
+    delete b->free;
+    delete b;
+  }
+  delete merger;
+}
+
+void cadidaq::readout::start(){
+  if (running){
+    DAQ_LOG_WARN << "Readout already running!";
+    return;
+  }
+  unsigned ncpu = std::thread::hardware_concurrency();
+  running = true;
+  int idx = 0;
+  for (auto b : boards){
+    // preallocate all buffers before the acquisition starts so that the readout loop never allocates
+    if (b->buffers.empty()){
+      // one additional scratch buffer for reading data that has to be dropped
+      b->buffers.resize(*settings->readoutBuffers.first + 1);
+      for (auto& buffer : b->buffers){
+        if (!b->digi->allocateBuffer(buffer)){
+          DAQ_LOG_ERROR << "Could not allocate readout buffers for digitizer '" << b->digi->getName() << "', skipping it in the readout.";
+          for (auto& allocated : b->buffers)
+            b->digi->freeBuffer(allocated);
+          b->buffers.clear();
+          break;
+        }
+      }
+      for (std::size_t i = 0; i + 1 < b->buffers.size(); i++)
+        b->free->push(&b->buffers[i]);
+    }
+    if (b->buffers.empty())
+      continue;
+    // the event layout follows from the settings the board has been configured with
+    const boardInfo& info = b->digi->getBoardInfo();
+    delete b->decoder;
+    delete b->hitDecoder;
+    b->decoder = info.hasDppFw ? nullptr : new standardDecoder(info, b->digi->getRegisterSettings());
+    b->hitDecoder = dppDecoder::supports(info) ? new dppDecoder(info, b->digi->getRegisterSettings()) : nullptr;
+    if (info.hasDppFw && !b->hitDecoder)
+      DAQ_LOG_INFO << "Data of the DPP firmware " << info.amcFirmware << " of digitizer '" << b->digi->getName() << "' will not be decoded.";
+    // reserve core 0 for the main thread where possible
+    int cpu = (*settings->pinReadoutThreads.first && ncpu > 0) ? (int)((idx + 1) % ncpu) : -1;
+    b->thread = std::thread(&cadidaq::readout::readoutLoop, this, b, cpu);
+    idx++;
+  }
+  delete merger;
+  merger = nullptr;
+  if (settings->mergeWindow.first){
+    // the hits of a DPP aggregate are sorted per channel, so each channel is an input of its own
+    std::size_t inputs = 0;
+    for (auto b : boards){
+      b->firstInput = inputs;
+      b->untimedHits = 0;
+      if (b->decoder)
+        inputs++;
+      else if (b->hitDecoder)
+        inputs += b->digi->getBoardInfo().channels;
+    }
+    merger = new recordMerger(inputs, *settings->mergeWindow.first*uint64_t(1000), maxMergeQueue);
+    DAQ_LOG_INFO << "Merging events and hits of all digitizers in time order with a window of " << *settings->mergeWindow.first << " us.";
+  }
+  consuming = true;
+  consumer = std::thread(&cadidaq::readout::consumerLoop, this);
+  DAQ_LOG_INFO << "Started readout of " << idx << " digitizer(s) using " << *settings->readoutBuffers.first << " buffers each.";
+}
+
+void cadidaq::readout::stop(){
+  if (!running)
+    return;
+  running = false;
+  for (auto b : boards){
+    if (b->thread.joinable())
+      b->thread.join();
+  }
+  // the consumer drains what the readout threads left behind before terminating
+  consuming = false;
+  if (consumer.joinable())
+    consumer.join();
+  DAQ_LOG_INFO << "Readout stopped.";
+}
+
+/** Loop performing block transfers for a single digitizer until the readout is stopped.
+    Runs in its own thread and only uses the buffers preallocated in start(). */
+void cadidaq::readout::readoutLoop(board* b, int cpu){
+  // logger for this thread attributing all records to the digitizer
+  boost::log::sources::severity_channel_logger< boost::log::trivial::severity_level, std::string > lg;
+  lg.add_attribute("Digitizer", boost::log::attributes::constant<std::string>(b->digi->getName()));
+
+#ifdef __linux__
+  if (cpu >= 0){
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0)
+      DAQ_LOG_WARN << "Could not pin readout thread to CPU " << cpu;
+    else
+      DAQ_LOG_DEBUG << "Pinned readout thread to CPU " << cpu;
+  }
+#endif
+
+  // binary trace of the per-buffer events of this thread
+  cadidaq::traceLog trace;
+  if (settings->traceDirectory.first){
+    std::string path = *settings->traceDirectory.first + "/" + b->digi->getName() + ".trace";
+    if (trace.open(path, b->digi->getName(), *settings->traceRecords.first))
+      DAQ_LOG_INFO << "Writing readout trace to " << path;
+    else
+      DAQ_LOG_WARN << "Could not open trace file " << path << ": " << std::strerror(errno);
+  }
+
+  if (!b->digi->startAcquisition())
+    return;
+  b->startTime = std::chrono::steady_clock::now();
+  trace.record(traceEvent::ACQUISITION_START);
+
+  readoutBuffer* scratch = &b->buffers.back();
+  readoutBuffer* current = nullptr;
+  int consecutiveErrors = 0;
+  while (running){
+    // get a free buffer from the consumer or fall back to the scratch buffer if there is none
+    if (current == nullptr || current == scratch){
+      if (!b->free->pop(current))
+        current = scratch;
+    }
+    readoutBuffer& buffer = *current;
+    if (!b->digi->readData(buffer)){
+      b->errors++;
+      trace.record(traceEvent::READ_ERROR, consecutiveErrors + 1);
+      if (++consecutiveErrors >= maxConsecutiveErrors){
+        DAQ_LOG_FATAL << "Giving up readout after " << consecutiveErrors << " consecutive failed transfers!";
+        break;
+      }
+      continue;
+    }
+    consecutiveErrors = 0;
+    if (buffer.dataSize == 0){
+      // nothing to read: back off shortly instead of hammering the bus
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+    b->transfers++;
+    b->bytes += buffer.dataSize;
+    b->events += buffer.nEvents;
+    if (current == scratch){
+      // back-pressure: consumer did not return any buffer in time
+      b->droppedTransfers++;
+      b->droppedEvents += buffer.nEvents;
+      trace.record(traceEvent::DROPPED_TRANSFER, buffer.nEvents, buffer.dataSize);
+      continue;
+    }
+    trace.record(traceEvent::TRANSFER, buffer.nEvents, buffer.dataSize);
+    // cannot fail: the ring holds as many entries as there are buffers
+    b->filled->push(current);
+    current = nullptr;
+  }
+  // hand back a buffer we might still hold
+  if (current != nullptr && current != scratch)
+    b->filled->push(current);
+
+  b->digi->stopAcquisition();
+  b->stopTime = std::chrono::steady_clock::now();
+  trace.record(traceEvent::ACQUISITION_STOP, 0, b->transfers, b->events);
+}
+
+/// passes all filled buffers to the handler and returns them to the readout threads; returns false if there were none
+bool cadidaq::readout::consume(){
+  bool any = false;
+  auto emitter = [this](const timedRecord& record, std::size_t){emit(record);};
+  for (auto b : boards){
+    readoutBuffer* buffer;
+    const boardInfo& info = b->digi->getBoardInfo();
+    while (b->filled->pop(buffer)){
+      any = true;
+      if (b->decoder && merger)
+        b->decoder->decode(buffer->data, buffer->dataSize, [&](const eventView& event){
+          timedRecord record = {};
+          record.time = event.time*info.tickPeriod;
+          record.counter = event.eventCounter();
+          record.channel = timedRecord::EVENT;
+          record.board = b->index;
+          merger->push(b->firstInput, record, emitter);
+        });
+      else if (b->decoder)
+        b->decoder->decode(buffer->data, buffer->dataSize, [](const eventView&){});
+      else if (b->hitDecoder && merger)
+        b->hitDecoder->decode(buffer->data, buffer->dataSize, [&](const dppHit& hit){
+          if (!(hit.flags & dppHit::TIME) || hit.channel >= info.channels){
+            b->untimedHits++;
+            return;
+          }
+          timedRecord record = {};
+          record.time = hit.timeTag*info.tickPeriod;
+          record.energy = hit.energy;
+          record.chargeLong = hit.chargeLong;
+          record.fineTime = hit.fineTime;
+          record.flags = hit.flags;
+          record.channel = hit.channel;
+          record.board = b->index;
+          merger->push(b->firstInput + hit.channel, record, emitter);
+        });
+      else if (b->hitDecoder)
+        b->hitDecoder->decode(buffer->data, buffer->dataSize, [](const dppHit&){});
+      if (merger)
+        merger->release(emitter);
+      if (handler && buffer->dataSize > 0)
+        handler(b->digi, *buffer);
+      b->free->push(buffer);
+    }
+  }
+  return any;
+}
+
+void cadidaq::readout::consumerLoop(){
+  while (consuming){
+    if (!consume())
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  consume();
+  // nothing arrives any more to wait for
+  if (merger)
+    merger->flush([this](const timedRecord& record, std::size_t){emit(record);});
+}
+
+void cadidaq::readout::printStatistics(){
+  for (auto b : boards){
+    double seconds = std::chrono::duration<double>(b->stopTime - b->startTime).count();
+    if (seconds <= 0.)
+      seconds = 1.;
+    DAQ_LOG_INFO << "Readout statistics for digitizer '" << b->digi->getName() << "':" << std::endl
+                 << "\t Transfers:\t" << b->transfers << std::endl
+                 << "\t Events:\t"    << b->events << " (" << b->events/seconds << " Hz)" << std::endl
+                 << "\t Data:\t\t"    << b->bytes/1048576. << " MiB (" << b->bytes/1048576./seconds << " MiB/s)" << std::endl
+                 << "\t Dropped:\t"   << b->droppedTransfers << " transfers (" << b->droppedEvents << " events)" << std::endl
+                 << "\t Queue:\t\t"  << "high-water mark " << b->filled->highWaterMark() << " of " << (b->buffers.empty() ? 0 : b->buffers.size() - 1) << " buffers, "
+                 << b->filled->dropped() + b->free->dropped() << " pushes onto a full ring" << std::endl
+                 << "\t Errors:\t"    << b->errors;
+    if (b->decoder)
+      DAQ_LOG_INFO << "Decoded " << b->decoder->getEvents() << " events of digitizer '" << b->digi->getName() << "' ("
+                   << b->decoder->getUnexpectedEvents() << " with unexpected channels or size, "
+                   << b->decoder->getCorruptBuffers() << " buffer(s) with corrupt data); "
+                   << describeClock(b->decoder->getClock(), b->digi->getBoardInfo().tickPeriod);
+    if (b->hitDecoder)
+      DAQ_LOG_INFO << "Decoded " << b->hitDecoder->getHits() << " hits of digitizer '" << b->digi->getName() << "' ("
+                   << b->hitDecoder->getUnexpectedHits() << " with unexpected format, "
+                   << b->hitDecoder->getCorruptBuffers() << " buffer(s) with corrupt data); "
+                   << describeClock(b->hitDecoder->getClock(), b->digi->getBoardInfo().tickPeriod);
+  }
+  if (merger){
+    uint64_t untimed = 0;
+    for (auto b : boards)
+      untimed += b->untimedHits;
+    DAQ_LOG_INFO << "Merged " << merger->getMerged() << " events and hits of " << merger->inputs() << " input(s) in time order ("
+                 << merger->getLate() << " late ones passed on out of order, "
+                 << merger->getForced() << " released early from full queues, "
+                 << untimed << " hits without time tag left out); high-water mark " << merger->highWaterMark() << " records";
+  }
+}
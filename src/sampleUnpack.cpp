@@ -0,0 +1,223 @@
+#include <sampleUnpack.hpp>
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+// the vector kernels are compiled for their instruction set regardless of the compiler flags and only called if the CPU supports it
+#define CADIDAQ_HAVE_X86_KERNELS
+#define CADIDAQ_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+using cadidaq::channelData;
+
+//
+// scalar kernels, also used for the samples left over by the vector kernels
+//
+
+/// samples [first, nSamples) of two samples per word
+static void unpackPairsScalar(const channelData& d, uint16_t* out, uint32_t first = 0){
+  uint32_t i = first;
+  for (; i + 2 <= d.nSamples; i += 2){
+    uint32_t w = d.words[i/2];
+    out[i]     = w & d.sampleMask;
+    out[i + 1] = (w >> 16) & d.sampleMask;
+  }
+  if (i < d.nSamples)
+    out[i] = d.sample(i);
+}
+
+/// samples [first, nSamples) of three 10-bit samples per word; first has to be a multiple of 3
+static void unpackTripletsScalar(const channelData& d, uint16_t* out, uint32_t first = 0){
+  uint32_t i = first;
+  for (; i + 3 <= d.nSamples; i += 3){
+    uint32_t w = d.words[i/3];
+    out[i]     = w & d.sampleMask;
+    out[i + 1] = (w >> 10) & d.sampleMask;
+    out[i + 2] = (w >> 20) & d.sampleMask;
+  }
+  for (; i < d.nSamples; i++)
+    out[i] = d.sample(i);
+}
+
+/// samples of the blocks [first, nSamples/3) of 9 words holding 3 12-bit samples of each channel of the group
+static void unpackGroup12Scalar(const channelData& d, uint16_t* out, uint32_t first = 0){
+  // the channel's 3 samples of each block are 36 consecutive bits, which fit into the two words they start in
+  uint32_t bit = d.subChannel*36;
+  uint32_t b = first;
+  for (; (b + 1)*3 <= d.nSamples; b++){
+    const uint32_t* w = d.words + b*9 + bit/32;
+    uint64_t v = (w[0] | (uint64_t)w[1] << 32) >> (bit%32);
+    out[3*b]     = v & d.sampleMask;
+    out[3*b + 1] = (v >> 12) & d.sampleMask;
+    out[3*b + 2] = (v >> 24) & d.sampleMask;
+  }
+  for (uint32_t i = 3*b; i < d.nSamples; i++)
+    out[i] = d.sample(i);
+}
+
+static void pairsScalar(const channelData& d, uint16_t* out)    {unpackPairsScalar(d, out);}
+static void tripletsScalar(const channelData& d, uint16_t* out) {unpackTripletsScalar(d, out);}
+static void group12Scalar(const channelData& d, uint16_t* out)  {unpackGroup12Scalar(d, out);}
+
+#ifdef CADIDAQ_HAVE_X86_KERNELS
+
+//
+// SSE2: three samples of a word (or block) are spread over a 64-bit lane as 16-bit values, two lanes are then
+// squeezed into 12 bytes and stored with a 16-byte store whose surplus is overwritten by the next one
+//
+
+/// moves the fields [0, bits), [bits, 2*bits) and [2*bits, 3*bits) of each 64-bit lane to bits 0, 16 and 32 and packs both lanes into the low 12 bytes
+CADIDAQ_TARGET("sse2")
+static inline __m128i spreadTriplets(__m128i x, int bits){
+  __m128i field = _mm_set1_epi64x((1 << bits) - 1);
+  __m128i t = _mm_or_si128(_mm_and_si128(x, field),
+              _mm_or_si128(_mm_and_si128(_mm_slli_epi64(x, 16 - bits), _mm_slli_epi64(field, 16)),
+                           _mm_and_si128(_mm_slli_epi64(x, 32 - 2*bits), _mm_slli_epi64(field, 32))));
+  return _mm_or_si128(_mm_move_epi64(t), _mm_slli_si128(_mm_unpackhi_epi64(t, _mm_setzero_si128()), 6));
+}
+
+CADIDAQ_TARGET("sse2")
+static void pairsSse2(const channelData& d, uint16_t* out){
+  // the samples already sit in 16-bit halves of the words
+  const __m128i mask = _mm_set1_epi16(d.sampleMask);
+  uint32_t i = 0;
+  for (; i + 8 <= d.nSamples; i += 8)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(d.words + i/2)), mask));
+  unpackPairsScalar(d, out, i);
+}
+
+CADIDAQ_TARGET("sse2")
+static void tripletsSse2(const channelData& d, uint16_t* out){
+  uint32_t i = 0;
+  for (; i + 8 <= d.nSamples; i += 6){
+    __m128i x = _mm_unpacklo_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(d.words + i/3)), _mm_setzero_si128());
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), spreadTriplets(x, 10));
+  }
+  unpackTripletsScalar(d, out, i);
+}
+
+CADIDAQ_TARGET("sse2")
+static void group12Sse2(const channelData& d, uint16_t* out){
+  const char* bytes = reinterpret_cast<const char*>(d.words) + d.subChannel*36/8;
+  const __m128i shift = _mm_cvtsi32_si128(d.subChannel*36%8);
+  uint32_t nBlocks = d.nSamples/3, b = 0;
+  // 8-byte loads of two blocks; the last block is left to the scalar kernel so that no load crosses the end of the data
+  for (; b + 3 <= nBlocks; b += 2){
+    __m128i x = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes + b*36)),
+                                   _mm_loadl_epi64(reinterpret_cast<const __m128i*>(bytes + b*36 + 36)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 3*b), spreadTriplets(_mm_srl_epi64(x, shift), 12));
+  }
+  unpackGroup12Scalar(d, out, b);
+}
+
+//
+// AVX2
+//
+
+CADIDAQ_TARGET("avx2")
+static void pairsAvx2(const channelData& d, uint16_t* out){
+  const __m256i mask = _mm256_set1_epi16(d.sampleMask);
+  uint32_t i = 0;
+  for (; i + 16 <= d.nSamples; i += 16)
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(d.words + i/2)), mask));
+  unpackPairsScalar(d, out, i);
+}
+
+CADIDAQ_TARGET("avx2")
+static void tripletsAvx2(const channelData& d, uint16_t* out){
+  // 24 samples from 8 words: each 32-bit lane picks the word of its sample and shifts the sample down
+  const __m256i word0  = _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2),   shift0 = _mm256_setr_epi32(0, 10, 20, 0, 10, 20, 0, 10);
+  const __m256i word1  = _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5),   shift1 = _mm256_setr_epi32(20, 0, 10, 20, 0, 10, 20, 0);
+  const __m256i word2  = _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7),   shift2 = _mm256_setr_epi32(10, 20, 0, 10, 20, 0, 10, 20);
+  const __m256i mask = _mm256_set1_epi32(d.sampleMask);
+  uint32_t i = 0;
+  for (; i + 24 <= d.nSamples; i += 24){
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d.words + i/3));
+    __m256i s0 = _mm256_and_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(x, word0), shift0), mask);
+    __m256i s1 = _mm256_and_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(x, word1), shift1), mask);
+    __m256i s2 = _mm256_and_si256(_mm256_srlv_epi32(_mm256_permutevar8x32_epi32(x, word2), shift2), mask);
+    // packing works within 128-bit lanes, the permute restores the order of the samples
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_permute4x64_epi64(_mm256_packus_epi32(s0, s1), 0xD8));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16), _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi32(s2, s2), 0xD8)));
+  }
+  unpackTripletsScalar(d, out, i);
+}
+
+CADIDAQ_TARGET("avx2")
+static void group12Avx2(const channelData& d, uint16_t* out){
+  const char* bytes = reinterpret_cast<const char*>(d.words) + d.subChannel*36/8;
+  const __m128i shift = _mm_cvtsi32_si128(d.subChannel*36%8);
+  const __m256i blocks = _mm256_setr_epi64x(0, 36, 72, 108);
+  const __m256i field = _mm256_set1_epi64x(0xFFF);
+  // squeezes the 6 bytes of samples in each 64-bit lane together, within each 128-bit lane
+  const __m256i squeeze = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1,
+                                           0, 1, 2, 3, 4, 5, 8, 9, 10, 11, 12, 13, -1, -1, -1, -1);
+  uint32_t nBlocks = d.nSamples/3, b = 0;
+  // 8-byte loads of four blocks; the last block is left to the scalar kernel so that no load crosses the end of the data
+  for (; b + 5 <= nBlocks; b += 4){
+    __m256i x = _mm256_srl_epi64(_mm256_i64gather_epi64(reinterpret_cast<const long long*>(bytes + b*36), blocks, 1), shift);
+    __m256i t = _mm256_or_si256(_mm256_and_si256(x, field),
+                _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi64(x, 4), _mm256_slli_epi64(field, 16)),
+                                _mm256_and_si256(_mm256_slli_epi64(x, 8), _mm256_slli_epi64(field, 32))));
+    t = _mm256_shuffle_epi8(t, squeeze);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 3*b), _mm256_castsi256_si128(t));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 3*b + 6), _mm256_extracti128_si256(t, 1));
+  }
+  unpackGroup12Scalar(d, out, b);
+}
+
+#endif
+
+cadidaq::simdLevel cadidaq::detectSimdLevel(){
+#ifdef CADIDAQ_HAVE_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return simdLevel::AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return simdLevel::SSE2;
+#endif
+  return simdLevel::SCALAR;
+}
+
+cadidaq::unpackKernel cadidaq::selectUnpackKernel(cadidaq::sampleLayout layout, cadidaq::simdLevel level){
+  // kernels by layout (PAIRS, TRIPLETS, GROUP_12) and instruction set
+  static const unpackKernel scalar[] = {pairsScalar, tripletsScalar, group12Scalar};
+#ifdef CADIDAQ_HAVE_X86_KERNELS
+  static const unpackKernel sse2[] = {pairsSse2, tripletsSse2, group12Sse2};
+  static const unpackKernel avx2[] = {pairsAvx2, tripletsAvx2, group12Avx2};
+  if (level >= simdLevel::AVX2)
+    return avx2[(int)layout];
+  if (level >= simdLevel::SSE2)
+    return sse2[(int)layout];
+#endif
+  return scalar[(int)layout];
+}
+
+/// kernels for the CPU we run on, chosen once at start-up
+static const cadidaq::simdLevel cpuLevel = cadidaq::detectSimdLevel();
+static const cadidaq::unpackKernel kernels[] = {
+  cadidaq::selectUnpackKernel(cadidaq::sampleLayout::PAIRS, cpuLevel),
+  cadidaq::selectUnpackKernel(cadidaq::sampleLayout::TRIPLETS, cpuLevel),
+  cadidaq::selectUnpackKernel(cadidaq::sampleLayout::GROUP_12, cpuLevel)
+};
+
+void cadidaq::channelData::unpack(uint16_t* out) const {
+  kernels[(int)layout](*this, out);
+}
+
+constexpr std::size_t cadidaq::sampleBuffer::alignment;
+constexpr uint32_t cadidaq::sampleBuffer::vectorSamples;
+
+const uint16_t* cadidaq::sampleBuffer::unpack(const cadidaq::channelData& data){
+  nSamples = data.nSamples;
+  std::size_t needed = paddedSize() + vectorSamples - 1;
+  if (storage.size() < needed || !samples){
+    storage.resize(std::max(needed, storage.size()));
+    std::size_t offset = reinterpret_cast<uintptr_t>(storage.data())/sizeof(uint16_t) % vectorSamples;
+    samples = storage.data() + (offset ? vectorSamples - offset : 0);
+  }
+  data.unpack(samples);
+  std::fill(samples + nSamples, samples + paddedSize(), 0);
+  return samples;
+}
@@ -3,9 +3,9 @@
 #include <string>
 #include <sstream>
 #include <iostream>
-#include <iomanip>   // std::hex
+#include <numeric>   // accumulate
 #include <stdexcept> // exceptions
-#include <iterator>  // distance
+#include <type_traits> // enable_if
 
 // BOOST
 #include <boost/property_tree/ptree.hpp>
@@ -25,16 +25,18 @@
 #include <CaenEnum2str.hpp> // generated by CMake in build directory
 #include <helper.hpp>       // helper functions
 
+#include <logLevel.hpp> // CADIDAQ_LOG_CHANNEL_SEV
+
 #define CFG_LOG_DEBUG                                           \
-  BOOST_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::debug)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::debug)
 #define CFG_LOG_INFO                                          \
-  BOOST_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::info)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::info)
 #define CFG_LOG_WARN                                              \
-  BOOST_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::warning)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::warning)
 #define CFG_LOG_ERROR                                           \
-  BOOST_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::error)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::error)
 #define CFG_LOG_FATAL                                           \
-  BOOST_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::fatal)
+  CADIDAQ_LOG_CHANNEL_SEV(lg, "cfg", boost::log::trivial::fatal)
 
 //
 // Helper functions
@@ -44,17 +46,12 @@
     uses template specialization to cover CAEN enums, ints, bools */
 template <typename CAEN_ENUM>
 std::string describeValidValues(){
-  // get a converter for this CAEN enum type
-  cadidaq::CaenEnum2str enumConverter;
-  CAEN_ENUM e;
-  auto* map = enumConverter.getBimap(e);
-  // generate a string of known options from the CAEN enum map
+  // generate a string of known options from the CAEN enum's lookup table
   std::stringstream knownOptions;
-  std::string enumRoot = findEnumRoot(*map);
-  typedef typename boost::bimap< std::string, CAEN_ENUM >::left_const_iterator const_iterator;
-  for( const_iterator i = map->left.begin(), iend = map->left.end(); i != iend; ++i ){
-    knownOptions << boost::erase_head_copy(i->first, enumRoot.length());
-    if (!is_last(i, map->left)) knownOptions << ", ";
+  const auto& names = caenEnumTable<CAEN_ENUM>::get().names();
+  for (auto i = names.begin(); i != names.end(); ++i){
+    knownOptions << *i;
+    if (!is_last(i, names)) knownOptions << ", ";
   }
   return knownOptions.str();
 }
@@ -70,6 +67,10 @@ template <>
 std::string describeValidValues<bool>(){
   return std::string("boolean value noted as either 0/1 or true/false");
 }
+template <>
+std::string describeValidValues<std::string>(){
+  return std::string("any text");
+}
 
 //
 // Class implementation
@@ -92,7 +93,29 @@ void cadidaq::settingsBase::print(){
 };
 
 void cadidaq::settingsBase::parse(pt::iptree *node){
+  indexKeys(node);
   processPTree(node, parseDirection::READING);
+  keyIndex.clear();
+}
+
+/// builds the index of all keys in the node once, so that looking up the keys of a setting does not scan the whole section
+void cadidaq::settingsBase::indexKeys(pt::iptree *node){
+  keyIndex.clear();
+  keyIndex.reserve(node->size());
+  for (auto&& key : *node){
+    std::string base = key.first.substr(0, key.first.find_first_of("[("));
+    boost::trim_right(base);
+    boost::to_lower(base);
+    keyIndex[base].push_back(key.first);
+  }
+}
+
+const std::vector<std::string>& cadidaq::settingsBase::matchingKeys(const std::string& settingName){
+  static const std::vector<std::string> none;
+  auto it = keyIndex.find(boost::to_lower_copy(settingName));
+  if (it == keyIndex.end())
+    return none;
+  return it->second;
 }
 
 pt::iptree* cadidaq::settingsBase::createPTree(){
@@ -105,6 +128,18 @@ void cadidaq::settingsBase::fillPTree(pt::iptree *node){
   processPTree(node, parseDirection::WRITING);
 }
 
+/// a setting's value in hex notation (integer types only, others are written as they are)
+template <typename VALUE>
+static typename std::enable_if<std::is_integral<VALUE>::value || std::is_enum<VALUE>::value, std::string>::type hexString(const VALUE& value){
+  return hex2str(static_cast<uint64_t>(value));
+}
+template <typename VALUE>
+static typename std::enable_if<!(std::is_integral<VALUE>::value || std::is_enum<VALUE>::value), std::string>::type hexString(const VALUE& value){
+  std::stringstream ss;
+  ss << value;
+  return ss.str();
+}
+
 template <class VALUE> void cadidaq::settingsBase::parseSetting(std::string settingName, pt::iptree *node, boost::optional<VALUE>& settingValue, parseDirection direction, parseFormat format){
   if (direction == parseDirection::READING){
     // get the setting's value from the ptree
@@ -131,9 +166,7 @@ template <class VALUE> void cadidaq::settingsBase::parseSetting(std::string sett
     // add key to ptree if the setting's value has been set
     if (settingValue) {
       if (format == parseFormat::HEX){
-        std::stringstream ss;
-        ss << std::hex << std::showbase << settingValue; // might need e.g. std::setfill ('0') and std::setw(sizeof(your_type)*2)
-        node->put(settingName, ss.str());
+        node->put(settingName, hexString(*settingValue));
       } else {
         node->put(settingName, *settingValue);
       }
@@ -144,82 +177,71 @@ template <class VALUE> void cadidaq::settingsBase::parseSetting(std::string sett
 }
 
 
-template <typename VALUE> void cadidaq::settingsBase::parseSetting(std::string settingName, pt::iptree *node, std::vector<boost::optional<VALUE>>& settingValue, parseDirection direction, parseFormat format){
+template <typename VALUE> void cadidaq::settingsBase::parseSetting(std::string settingName, pt::iptree *node, Vec<VALUE>& settingValue, parseDirection direction, parseFormat format){
   if (direction == parseDirection::READING){
-    std::vector<std::string> matchingKeys;
     // get the setting's value from the ptree by looping over all entries of "settingName[RANGE]"
-    for (auto&& key : *node)
-      if (boost::istarts_with(key.first, settingName))
-        matchingKeys.push_back(key.first);
-
-    if (matchingKeys.empty()){
+    const std::vector<std::string>& keys = matchingKeys(settingName);
+    if (keys.empty()){
       CFG_LOG_DEBUG << "Found no matching keys for setting " << settingName;
       return;
     } else
-      CFG_LOG_DEBUG << "Found " << matchingKeys.size() << " matching keys for setting '" << settingName << "'";
-
-    for (auto&& it : matchingKeys){
-      // extract the range
-      std::string range = boost::erase_head_copy(it, settingName.length());
-      // remove the brackets or parenthesis and any remaining whitespace
-      boost::trim_left_if(range,boost::is_any_of("[("));
-      boost::trim_right_if(range,boost::is_any_of(")]"));
-      // make sure that there are no characters present that we can't parse
-      if (!boost::all(range,boost::is_any_of(",-*")||boost::is_digit() || boost::is_space())){
-        CFG_LOG_ERROR << "Could not parse range '" << range << "' specified in setting '" << it << "'. Only allowed characters are '*', '-', ',' and digits.";
+      CFG_LOG_DEBUG << "Found " << keys.size() << " matching keys for setting '" << settingName << "'";
+
+    // channels listed in the key currently parsed
+    std::vector<uint64_t> channels(settingValue.words());
+    for (auto&& it : keys){
+      // extract the range by removing the brackets or parenthesis around it
+      const char* begin = it.data() + settingName.length();
+      const char* end = it.data() + it.size();
+      while (begin != end && (*begin == '[' || *begin == '(')) begin++;
+      while (end != begin && (end[-1] == ']' || end[-1] == ')')) end--;
+      const boost::iterator_range<const char*> range(begin, end);
+      // now parse the range into the channel mask
+      std::fill(channels.begin(), channels.end(), 0);
+      rangeError error;
+      bool parsed = parseChannelRange(begin, end, settingValue.size(), channels.data(), error, [&](uint64_t first, uint64_t last){
+          if (first == last)
+            CFG_LOG_ERROR << "Channel number '" << first << "' in setting '" << settingName << "' is out of range!";
+          else
+            CFG_LOG_ERROR << "Channel numbers '" << first << "-" << last << "' in setting '" << settingName << "' are out of range!";
+        });
+      if (!parsed){
+        CFG_LOG_ERROR << "Could not parse range '" << range << "' specified in setting '" << it << "': " << error.message << " at position " << error.position << " ('" << boost::make_iterator_range(begin, begin + error.position) << ">>" << boost::make_iterator_range(begin + error.position, end) << "').";
         continue;
       }
-      // now split the range into individual channel numbers
-      std::vector<int> v;
-      // special treatment if the remaining character is an asterix
-      if (boost::find_first(range,"*")){
-        // use setting for all channels
-        for (int i = 0; i < settingValue.size(); i++) v.push_back(i);
-        CFG_LOG_DEBUG << "   Found '*' in range -> using settings's value for all channels";
-      } else {
-        // parse the range
-        v = expandRange(range);
-      }
-
-      // output the parsed range for debugging purposes
-      std::stringstream expandedrange;
-      for(auto x:v)
-        expandedrange << std::to_string(x) << " ";
-      CFG_LOG_DEBUG << "   Expanded range '" << range << "' into " << expandedrange.str();
+      CFG_LOG_DEBUG << "   Expanded range '" << range << "' into " << std::accumulate(channels.begin(), channels.end(), std::size_t(0), [](std::size_t n, uint64_t w){ return n + cadidaq::detail::popcount(w); }) << " channel(s)";
 
-      // loop over parsed range and set the values in the settings vector
+      // set the values of the channels listed in the settings vector
       boost::optional<VALUE> value;
       parseSetting(it, node, value, direction);
       if (!value) continue; // value not valid, try next key
-      for(auto x:v){
-        try{
-          settingValue.at(x) = *value;
-        }
-        catch (const std::out_of_range& e) {
-          CFG_LOG_ERROR << "Channel number '" << std::to_string(x) << "' in setting '" << settingName << "' is out of range!";
-          continue;
-        }
-      }
+      settingValue.set(channels.data(), *value);
     } // matchingKeys
   } else {
     // direction: WRITING
-    // TODO: write range compression to get setting string as in "settingName[RANGE]"
-    // add key to ptree if the setting's value has been set
-    for (auto it = settingValue.begin(); it != settingValue.end(); ++it) {
-      auto index = std::distance(settingValue.begin(), it);
-      if (*it) {
-        if (format == parseFormat::HEX){
-          std::stringstream ss;
-          ss << std::hex << std::showbase << **it; // might need e.g. std::setfill ('0') and std::setw(sizeof(your_type)*2)
-          node->put(settingName + "[" + std::to_string(index) + "]", ss.str());
-        } else {
-          node->put(settingName + "[" + std::to_string(index) + "]", **it);
-        }
-      } else {
+    // add one key per distinct value set, listing the channels holding it as range: "settingName[RANGE]"
+    std::vector<uint64_t> channels(settingValue.words());
+    std::vector<uint64_t> written(settingValue.words(), 0);
+    for (std::size_t index = 0; index < settingValue.size(); index++) {
+      if (!settingValue.isSet(index)) {
         // TODO: this log messages should be degraded to 'debug' at a later
         // stage when we are confident in the correct parsing of all parameters
         // for all different models and FW versions
         CFG_LOG_DEBUG << "Value for '" << settingName << "' not defined for channel #" << std::to_string(index) << " when writing configuration. Setting will be omitted in output.";
+        continue;
+      }
+      if ((written[index/64] >> (index%64)) & 1)
+        continue; // already part of the key of an earlier channel
+      const VALUE value = settingValue.value(index);
+      for (std::size_t w = 0; w < channels.size(); w++){
+        channels[w] = settingValue.matchingBits(w, value);
+        written[w] |= channels[w];
+      }
+      std::string key = settingName + "[" + formatChannelRange(channels.data(), settingValue.size()) + "]";
+      if (format == parseFormat::HEX){
+        node->put(key, hexString(value));
+      } else {
+        node->put(key, value);
       }
     }
   }
@@ -229,29 +251,20 @@ template <typename VALUE> void cadidaq::settingsBase::parseSetting(std::string s
 void cadidaq::settingsBase::parseRegisters(pt::iptree *node, std::vector< std::pair< uint32_t, uint32_t >>& registers, parseDirection direction){
   std::string settingName = "SetRegister";
   if (direction == parseDirection::READING){
-    std::vector<std::string> matchingKeys;
     // get the setting's value from the ptree by looping over all entries of "settingName[RANGE]"
-    for (auto&& key : *node)
-      if (boost::istarts_with(key.first, settingName))
-        matchingKeys.push_back(key.first);
-
-    if (matchingKeys.empty()){
+    const std::vector<std::string>& keys = matchingKeys(settingName);
+    if (keys.empty()){
       CFG_LOG_DEBUG << "Found no matching keys for setting " << settingName;
       return;
     } else
-      CFG_LOG_DEBUG << "Found " << matchingKeys.size() << " matching keys for setting '" << settingName << "'";
-
-    for (auto&& it : matchingKeys){
-      // extract the range
-      std::string address = boost::erase_head_copy(it, settingName.length());
-      // remove the brackets or parenthesis and any remaining whitespace
-      boost::trim_left_if(address,boost::is_any_of("[("));
-      boost::trim_right_if(address,boost::is_any_of(")]"));
-      // make sure that there are no characters present that we can't parse
-      if (!boost::all(address,boost::is_any_of("x,")||boost::is_digit() || boost::is_space())){
-        CFG_LOG_ERROR << "Could not parse register address '" << address << "' specified in setting '" << it << "'. Only allowed characters are comma-separated hex values.";
-        continue;
-      }
+      CFG_LOG_DEBUG << "Found " << keys.size() << " matching keys for setting '" << settingName << "'";
+
+    for (auto&& it : keys){
+      // extract the address(es) by removing the brackets or parenthesis around them
+      const char* begin = it.data() + settingName.length();
+      const char* end = it.data() + it.size();
+      while (begin != end && (*begin == '[' || *begin == '(')) begin++;
+      while (end != begin && (end[-1] == ']' || end[-1] == ')')) end--;
       // retrieve the key's value
       boost::optional<uint32_t> value;
       parseSetting(it, node, value, direction);
@@ -259,27 +272,22 @@ void cadidaq::settingsBase::parseRegisters(pt::iptree *node, std::vector< std::p
 
       // now split the potentially comma-separated address(es) into individual
       // addresses and keep the address-value pair in the given vector
-      std::vector<std::string> strs;
-      boost::split(strs,address,boost::is_any_of(","));
-      // expand values
-      for (auto it:strs){
-        boost::optional<uint32_t> adr = str2hex(it);
+      for (const char* first = begin; first <= end;){
+        const char* last = std::find(first, end, ',');
+        boost::optional<uint32_t> adr = str2hex(first, last);
         if (!adr){
-          CFG_LOG_ERROR << "Could not convert register address '" << it << "' to a number. Only allowed characters are comma-separated hex values.";
-          continue;
+          CFG_LOG_ERROR << "Could not convert register address '" << boost::make_iterator_range(first, last) << "' specified in setting '" << it << "' to a number. Only allowed characters are comma-separated hex values.";
+        } else {
+          registers.push_back(std::make_pair(*adr, *value));
+          CFG_LOG_DEBUG << "   Parsed config value '" << hex2str(*value) <<  "' for register address " << hex2str(*adr);
         }
-        registers.push_back(std::make_pair(*adr, *value));
-        CFG_LOG_DEBUG << "   Parsed config value '" << std::hex << std::showbase << *value <<  "' for register address " << *adr;
+        first = last + 1;
       }
     } // matchingKeys
   } else {
     // direction: WRITING
     for (auto it = registers.begin(); it != registers.end(); ++it) {
-      std::stringstream v;
-      std::stringstream s;
-      s << settingName << "[" << std::hex << std::showbase << it->first << "]";
-      v << std::hex << std::showbase << it->second;
-      node->put(s.str(), v.str());
+      node->put(settingName + "[" + hex2str(it->first) + "]", hex2str(it->second));
     }
   }
 }
@@ -329,69 +337,27 @@ void cadidaq::connectionSettings::processPTree(pt::iptree *node, parseDirection
   }
 
 
-cadidaq::registerSettings::registerSettings(std::string name, uint nchannels) : cadidaq::settingsBase(name) {
-  // data readout
-  maxNumEventsBLT     = std::make_pair(boost::none, "Expert_MaxNumEventsBLT");
-
-  // trigger settings
-  swTriggerMode       = std::make_pair(boost::none, "SWTriggerMode");
-  externalTriggerMode = std::make_pair(boost::none, "ExternalTriggerMode");
-  ioLevel             = std::make_pair(boost::none, "IOLevel");
-  chSelfTrigger       = std::make_pair(Vec<CAEN_DGTZ_TriggerMode_t>(nchannels), "ChannelSelfTrigger");
-  chTriggerThreshold  = std::make_pair(Vec<uint32_t>(nchannels), "ChannelTriggerTreshold");
-  chTriggerPolarity   = std::make_pair(Vec<CAEN_DGTZ_TriggerPolarity_t>(nchannels), "ChannelTriggerPolarity");
-  runSyncMode         = std::make_pair(boost::none, "RunSynchronizationMode");
-  outSignalMode       = std::make_pair(boost::none, "OutputSignalMode");
-
-  // acquisition settings
-  acquisitionMode     = std::make_pair(boost::none, "AcquisitionMode");
-  recordLength        = std::make_pair(boost::none, "RecordLength");
-  postTriggerSize     = std::make_pair(boost::none, "PostTriggerSize");
-  chEnable            = std::make_pair(Vec<bool>(nchannels), "EnableChannel");
-  chDCOffset          = std::make_pair(Vec<uint32_t>(nchannels), "ChannelDCOffset");
-  desMode             = std::make_pair(boost::none, "DESMode");
-
-  // DPP-FW settings
-  dppPreTriggerSize   = std::make_pair(Vec<uint32_t>(nchannels), "DPPPreTriggerSize");
-  dppChPulsePolarity  = std::make_pair(Vec<CAEN_DGTZ_PulsePolarity_t>(nchannels), "DPPChannelPulsePolarity");
-  dppAcqMode          = std::make_pair(boost::none, "DPPAcquisitionMode");
-  dppAcqModeParam     = std::make_pair(boost::none, "DPPAcquisitionModeParameter");
-  dppTriggermode      = std::make_pair(boost::none, "DPPTriggerMode");
-
+/// sets the name of a setting from the setting table and sizes channel vectors
+template <class VALUE> static void initSetting(cadidaq::settingsBase::option<VALUE>& setting, const char* key, uint){
+  setting = std::make_pair(boost::none, key);
+}
+template <class VALUE> static void initSetting(cadidaq::settingsBase::optionVector<VALUE>& setting, const char* key, uint nchannels){
+  setting = std::make_pair(cadidaq::settingsBase::Vec<VALUE>(nchannels), key);
 }
 
-
+cadidaq::registerSettings::registerSettings(std::string name, uint nchannels) : cadidaq::settingsBase(name) {
+#define CADIDAQ_INIT_SETTING(CONTAINER, TYPE, MEMBER, KEY, FORMAT, SCOPE, ACCESS, CHANNEL, GROUP) \
+  initSetting(MEMBER, KEY, nchannels);
+  CADIDAQ_REGISTER_SETTINGS(CADIDAQ_INIT_SETTING)
+#undef CADIDAQ_INIT_SETTING
+}
 
 void cadidaq::registerSettings::processPTree(pt::iptree *node, parseDirection direction){
   // this routine implements the calls to ParseSetting for individual settings read from config or stored internally
-
-  // data readout
-  parseSetting(maxNumEventsBLT, node, direction);
-
-  // trigger
-  parseSetting(swTriggerMode, node, direction);
-  parseSetting(externalTriggerMode, node, direction);
-  parseSetting(ioLevel, node, direction);
-  parseSetting(chSelfTrigger, node, direction);
-  parseSetting(chTriggerThreshold, node, direction);
-  parseSetting(chTriggerPolarity, node, direction);
-  parseSetting(runSyncMode, node, direction);
-  parseSetting(outSignalMode, node, direction);
-
-  // acquisition
-  parseSetting(recordLength, node, direction);
-  parseSetting(postTriggerSize, node, direction);
-  parseSetting(acquisitionMode, node, direction);
-  parseSetting(chEnable, node, direction);
-  parseSetting(chDCOffset, node, direction);
-  parseSetting(desMode, node, direction);
-
-  // DPP-FW
-  parseSetting(dppPreTriggerSize, node, direction);
-  parseSetting(dppChPulsePolarity, node, direction);
-  parseSetting(dppAcqMode, node, direction);
-  parseSetting(dppAcqModeParam, node, direction);
-  parseSetting(dppTriggermode, node, direction);
+#define CADIDAQ_PARSE_SETTING(CONTAINER, TYPE, MEMBER, KEY, FORMAT, SCOPE, ACCESS, CHANNEL, GROUP) \
+  parseSetting(MEMBER, node, direction, parseFormat::FORMAT);
+  CADIDAQ_REGISTER_SETTINGS(CADIDAQ_PARSE_SETTING)
+#undef CADIDAQ_PARSE_SETTING
 
   // register address-value settings
   parseRegisters(node, registerValues, direction);
@@ -400,7 +366,6 @@ void cadidaq::registerSettings::processPTree(pt::iptree *node, parseDirection di
 
 }
 
-
 void cadidaq::registerSettings::verify(){
   // TODO: implement "light" checks on e.g. critical options that are valid for all supported digitizer types/families (nothing model-dependent)
 
@@ -420,3 +385,62 @@ void cadidaq::registerSettings::verify(){
 
   CFG_LOG_DEBUG << "Done with verifying register settings.";
 }
+
+
+cadidaq::daqSettings::daqSettings(std::string name) : cadidaq::settingsBase(name) {
+  runDuration         = std::make_pair(boost::none, "RunDuration");
+  readoutBuffers      = std::make_pair(boost::none, "ReadoutBuffers");
+  pinReadoutThreads   = std::make_pair(boost::none, "PinReadoutThreads");
+  parallelConfiguration = std::make_pair(boost::none, "ParallelConfiguration");
+  asyncLogging        = std::make_pair(boost::none, "AsyncLogging");
+  logQueueSize        = std::make_pair(boost::none, "LogQueueSize");
+  logDropOnOverflow   = std::make_pair(boost::none, "LogDropOnOverflow");
+  traceDirectory      = std::make_pair(boost::none, "TraceDirectory");
+  traceRecords        = std::make_pair(boost::none, "TraceRecords");
+  mergeWindow         = std::make_pair(boost::none, "MergeWindow");
+}
+
+void cadidaq::daqSettings::processPTree(pt::iptree *node, parseDirection direction){
+  // this routine implements the calls to ParseSetting for individual settings read from config or stored internally
+  parseSetting(runDuration, node, direction);
+  parseSetting(readoutBuffers, node, direction);
+  parseSetting(pinReadoutThreads, node, direction);
+  parseSetting(parallelConfiguration, node, direction);
+  parseSetting(asyncLogging, node, direction);
+  parseSetting(logQueueSize, node, direction);
+  parseSetting(logDropOnOverflow, node, direction);
+  parseSetting(traceDirectory, node, direction);
+  parseSetting(traceRecords, node, direction);
+  parseSetting(mergeWindow, node, direction);
+  CFG_LOG_DEBUG << "Done with processing DAQ settings property tree";
+}
+
+void cadidaq::daqSettings::verify(){
+  if (!readoutBuffers.first){
+    CFG_LOG_DEBUG << readoutBuffers.second << " not set, assuming '4'";
+    readoutBuffers.first = 4;
+  }
+  if (*readoutBuffers.first < 2){
+    CFG_LOG_WARN << readoutBuffers.second << " needs to be at least '2'! Fixed.";
+    readoutBuffers.first = 2;
+  }
+  if (!pinReadoutThreads.first)
+    pinReadoutThreads.first = true;
+  if (!parallelConfiguration.first)
+    parallelConfiguration.first = true;
+  if (!asyncLogging.first)
+    asyncLogging.first = false;
+  if (!logQueueSize.first){
+    CFG_LOG_DEBUG << logQueueSize.second << " not set, assuming '8192'";
+    logQueueSize.first = 8192;
+  }
+  if (*logQueueSize.first < 16){
+    CFG_LOG_WARN << logQueueSize.second << " needs to be at least '16'! Fixed.";
+    logQueueSize.first = 16;
+  }
+  if (!logDropOnOverflow.first)
+    logDropOnOverflow.first = true;
+  if (!traceRecords.first)
+    traceRecords.first = 1 << 20;
+  CFG_LOG_DEBUG << "Done with verifying DAQ settings.";
+}
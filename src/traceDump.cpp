@@ -0,0 +1,149 @@
+/**
+ * Renders the binary trace files written by the readout (see traceLog.hpp) as text,
+ * merging the records of all given files in time order.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+#include <boost/program_options.hpp>
+
+#include <traceLog.hpp>
+
+namespace po = boost::program_options;
+
+struct traceEntry {
+  cadidaq::traceRecord record;
+  std::size_t          file;
+};
+
+struct traceSource {
+  std::string name;
+  int64_t     clockOffset;
+};
+
+static const char* eventName(uint16_t event){
+  switch (static_cast<cadidaq::traceEvent>(event)){
+  case cadidaq::traceEvent::ACQUISITION_START: return "ACQUISITION_START";
+  case cadidaq::traceEvent::ACQUISITION_STOP:  return "ACQUISITION_STOP";
+  case cadidaq::traceEvent::TRANSFER:          return "TRANSFER";
+  case cadidaq::traceEvent::DROPPED_TRANSFER:  return "DROPPED_TRANSFER";
+  case cadidaq::traceEvent::READ_ERROR:        return "READ_ERROR";
+  }
+  return "UNKNOWN";
+}
+
+static void printArguments(std::ostream& os, const cadidaq::traceRecord& r){
+  switch (static_cast<cadidaq::traceEvent>(r.event)){
+  case cadidaq::traceEvent::ACQUISITION_START:
+    break;
+  case cadidaq::traceEvent::ACQUISITION_STOP:
+    os << " transfers=" << r.a1 << " events=" << r.a2;
+    break;
+  case cadidaq::traceEvent::TRANSFER:
+  case cadidaq::traceEvent::DROPPED_TRANSFER:
+    os << " events=" << r.a0 << " bytes=" << r.a1;
+    break;
+  case cadidaq::traceEvent::READ_ERROR:
+    os << " consecutive=" << r.a0;
+    break;
+  default:
+    os << " a0=" << r.a0 << " a1=" << r.a1 << " a2=" << r.a2;
+  }
+}
+
+/// appends the records of a trace file to entries (oldest first); returns false if the file could not be read
+static bool readTraceFile(const std::string& path, std::size_t index, std::vector<traceSource>& sources, std::vector<traceEntry>& entries){
+  std::ifstream in(path, std::ios::binary);
+  if (!in){
+    std::cerr << "ERROR: could not open trace file '" << path << "'" << std::endl;
+    return false;
+  }
+  char headerBytes[sizeof(cadidaq::traceFileHeader)];
+  in.read(headerBytes, sizeof(headerBytes));
+  cadidaq::traceFileHeader header;
+  std::memcpy(&header, headerBytes, sizeof(header));
+  if (!in || std::memcmp(header.magic, cadidaq::traceFileHeader::magicString, sizeof(header.magic)) != 0){
+    std::cerr << "ERROR: '" << path << "' is not a CADiDAQ trace file" << std::endl;
+    return false;
+  }
+  if (header.version != cadidaq::traceFileHeader::currentVersion || header.recordSize != sizeof(cadidaq::traceRecord)){
+    std::cerr << "ERROR: trace file '" << path << "' has unsupported version " << header.version << std::endl;
+    return false;
+  }
+  uint64_t capacity = header.capacity;
+  uint64_t head = header.head;
+  traceSource source = {std::string(header.source, strnlen(header.source, sizeof(header.source))), header.clockOffset};
+  sources.push_back(source);
+
+  std::vector<cadidaq::traceRecord> ring(capacity);
+  in.read(reinterpret_cast<char*>(ring.data()), capacity * sizeof(cadidaq::traceRecord));
+  if (!in){
+    std::cerr << "ERROR: trace file '" << path << "' is truncated" << std::endl;
+    return false;
+  }
+  uint64_t first = head > capacity ? head - capacity : 0;
+  if (first > 0)
+    std::cerr << "NOTE: '" << path << "' wrapped around, " << first << " oldest record(s) were overwritten" << std::endl;
+  for (uint64_t i = first; i < head; i++){
+    traceEntry e = {ring[i & (capacity - 1)], index};
+    entries.push_back(e);
+  }
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  po::options_description desc("Options");
+  desc.add_options()
+    ("help,h", "Print help message")
+    ("file,f", po::value< std::vector<std::string> >(), "Trace file(s) written by cadidaq");
+  po::positional_options_description positional;
+  positional.add("file", -1);
+
+  po::variables_map vm;
+  try {
+    po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+  }
+  catch (po::error &e){
+    std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+    std::cout << "cadidaq-trace [options] file(s):" << std::endl << desc << std::endl;
+    return 1;
+  }
+  if (vm.count("help") || !vm.count("file")){
+    std::cout << "cadidaq-trace [options] file(s):" << std::endl << desc << std::endl;
+    return 0;
+  }
+
+  std::vector<traceSource> sources;
+  std::vector<traceEntry>  entries;
+  for (auto& path : vm["file"].as< std::vector<std::string> >()){
+    if (!readTraceFile(path, sources.size(), sources, entries))
+      return 1;
+  }
+  // files are in time order each, but need to be merged
+  std::stable_sort(entries.begin(), entries.end(), [](const traceEntry& a, const traceEntry& b){ return a.record.time < b.record.time; });
+
+  // same layout as the console log: "<line> <time>: <severity> [<channel>.<Digitizer>] <message>"
+  uint64_t line = 1;
+  for (auto& e : entries){
+    const traceSource& source = sources[e.file];
+    int64_t wall = (int64_t)e.record.time + source.clockOffset;
+    std::time_t seconds = wall / 1000000000;
+    std::tm tm;
+    localtime_r(&seconds, &tm);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &tm);
+    std::cout << line++ << " " << date << "." << std::setw(9) << std::setfill('0') << wall % 1000000000 << std::setfill(' ')
+              << ": <trace> [trace." << source.name << "] " << eventName(e.record.event);
+    printArguments(std::cout, e.record);
+    std::cout << "\n";
+  }
+  return 0;
+}
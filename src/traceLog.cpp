@@ -0,0 +1,67 @@
+#include <traceLog.hpp>
+
+#include <cstring>
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#define CADIDAQ_HAVE_MMAP
+#endif
+
+bool cadidaq::traceLog::open(const std::string& path, const std::string& source, std::size_t capacity){
+  close();
+#ifdef CADIDAQ_HAVE_MMAP
+  std::size_t n = 1;
+  while (n < capacity) n <<= 1;
+  std::size_t size = sizeof(traceFileHeader) + n * sizeof(traceRecord);
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    return false;
+  if (ftruncate(fd, size) != 0){
+    int err = errno;
+    ::close(fd);
+    errno = err;
+    return false;
+  }
+  void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  int err = errno;
+  // the mapping keeps the file referenced
+  ::close(fd);
+  if (map == MAP_FAILED){
+    errno = err;
+    return false;
+  }
+
+  header = static_cast<traceFileHeader*>(map);
+  std::memcpy(header->magic, traceFileHeader::magicString, sizeof(header->magic));
+  header->version    = traceFileHeader::currentVersion;
+  header->recordSize = sizeof(traceRecord);
+  header->capacity   = n;
+  __atomic_store_n(&header->head, 0, __ATOMIC_RELAXED);
+  header->clockOffset = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+    - std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  std::strncpy(header->source, source.c_str(), sizeof(header->source) - 1);
+  records = reinterpret_cast<traceRecord*>(static_cast<char*>(map) + sizeof(traceFileHeader));
+  mask    = n - 1;
+  mapSize = size;
+  return true;
+#else
+  errno = ENOSYS;
+  return false;
+#endif
+}
+
+void cadidaq::traceLog::close(){
+  if (!header)
+    return;
+#ifdef CADIDAQ_HAVE_MMAP
+  munmap(header, mapSize);
+#endif
+  header  = nullptr;
+  records = nullptr;
+  mask    = 0;
+  mapSize = 0;
+}
@@ -0,0 +1,123 @@
+// channelGroups.cpp
+// Programming of per-channel settings on the simulated device (simulation builds only): one device call per group of
+// channels on boards with grouped channels, one per channel otherwise, and no calls for values known to be on the
+// device. Device calls are counted by the simulation.
+
+#include <digitizer.hpp>
+#include <caen.hpp> // the simulated device (include/sim)
+
+#include <string>
+
+#include <boost/log/core.hpp>
+
+#include "testing.hpp"
+
+namespace pt = boost::property_tree;
+
+/// device calls made while configuring the (connected) digitizer with the given section
+static uint64_t callsToConfigure(cadidaq::digitizer& digi, const pt::iptree& section){
+  // parsing consumes the keys: work on a copy
+  pt::iptree node(section);
+  uint64_t before = digi.getDevice() ? digi.getDevice()->simulatedCalls() : 0;
+  CADIDAQ_CHECK(digi.configure(&node));
+  // also the link settings are taken out when reprogramming
+  CADIDAQ_CHECK_EQUAL(node.size(), 0u, "keys not recognized");
+  return digi.getDevice()->simulatedCalls() - before;
+}
+
+static pt::iptree boardSection(){
+  pt::iptree node;
+  node.put("LinkType", "usb");
+  node.put("LinkNum", 0);
+  node.put("RecordLength", 1000);
+  node.put("PostTriggerSize", 50);
+  node.put("ChannelDCOffset[*]", 0x8000);
+  node.put("ChannelTriggerTreshold[*]", 100);
+  return node;
+}
+
+static void groupedBoard(){
+  caen::simulation().model = CAEN_DGTZ_V1740;
+  caen::simulation().modelName = "V1740";
+  caen::simulation().channels = 64;
+  caen::simulation().groups = 8;
+  cadidaq::digitizer digi("grouped");
+  pt::iptree section = boardSection();
+  callsToConfigure(digi, section);
+  caen::Digitizer* dg = digi.getDevice();
+  CADIDAQ_CHECK(dg != nullptr);
+  if (!dg)
+    return;
+  for (uint32_t gr = 0; gr < 8; gr++)
+    CADIDAQ_CHECK_EQUAL(dg->getGroupDCOffset(gr), 0x8000u, "group " << gr);
+
+  // nothing changed: no calls at all
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 0u, "reprogramming unchanged settings");
+
+  // all channels of one group changed: one call for the group
+  section.put("ChannelDCOffset[8-15]", 0x1000);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 1u, "changing one group");
+  CADIDAQ_CHECK_EQUAL(dg->getGroupDCOffset(1), 0x1000u, "");
+
+  // channels of a group set to different values: one call with the value of the first channel
+  section.put("ChannelDCOffset[16-19]", 0x2000);
+  section.put("ChannelDCOffset[20-23]", 0x3000);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 1u, "changing one group inconsistently");
+  CADIDAQ_CHECK_EQUAL(dg->getGroupDCOffset(2), 0x2000u, "");
+
+  // one group of one setting and two groups of another
+  section.put("ChannelDCOffset[16-23]", 0x8000);
+  section.erase("ChannelDCOffset[16-19]");
+  section.erase("ChannelDCOffset[20-23]");
+  section.put("ChannelTriggerTreshold[48-63]", 200);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 3u, "changing three groups");
+  CADIDAQ_CHECK_EQUAL(dg->getGroupTriggerThreshold(6), 200u, "");
+  CADIDAQ_CHECK_EQUAL(dg->getGroupTriggerThreshold(7), 200u, "");
+
+  // SetRecordLength requires a subsequent call to SetPostTriggerSize, even if that is known to be on the device
+  section.put("RecordLength", 2000);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 2u, "changing the record length");
+}
+
+static void ungroupedBoard(){
+  caen::simulation().model = CAEN_DGTZ_V1751;
+  caen::simulation().modelName = "V1751";
+  caen::simulation().channels = 8;
+  caen::simulation().groups = 1;
+  cadidaq::digitizer digi("ungrouped");
+  pt::iptree section = boardSection();
+  callsToConfigure(digi, section);
+  caen::Digitizer* dg = digi.getDevice();
+  CADIDAQ_CHECK(dg != nullptr);
+  if (!dg)
+    return;
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 0u, "reprogramming unchanged settings");
+
+  // one call per changed channel
+  section.put("ChannelDCOffset[2-4]", 0x1000);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 3u, "changing three channels");
+  for (uint32_t ch = 0; ch < 8; ch++)
+    CADIDAQ_CHECK_EQUAL(dg->getChannelDCOffset(ch), (ch >= 2 && ch <= 4) ? 0x1000u : 0x8000u, "channel " << ch);
+
+  // raw register writes on top of the known settings
+  section.put("SetRegister[0x1098]", 5);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 1u, "writing a register");
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 0u, "reprogramming unchanged settings and registers");
+  // a setting written through the library may overwrite the register: it is written again after the setting
+  section.put("ChannelDCOffset[2-4]", 0x2000);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 3u + 1u, "changing three channels under a register write");
+  // raw register writes may touch any of the settings: once they change, everything is written again
+  section.put("SetRegister[0x1098]", 6);
+  CADIDAQ_CHECK(callsToConfigure(digi, section) >= 2*8 + 2 + 1);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 0u, "reprogramming after changing a register");
+  section.erase("SetRegister[0x1098]");
+  CADIDAQ_CHECK(callsToConfigure(digi, section) >= 2*8 + 2);
+  CADIDAQ_CHECK_EQUAL(callsToConfigure(digi, section), 0u, "reprogramming after removing a register");
+}
+
+int main(){
+  boost::log::core::get()->set_logging_enabled(false);
+  groupedBoard();
+  ungroupedBoard();
+  return cadidaq::testResult();
+}
@@ -0,0 +1,168 @@
+// channelRange.cpp
+// Fuzz test of parseChannelRange (helper.hpp) against the expandRange/boost::split parsing it replaced: exhaustive over
+// all expressions of up to 5 characters of a reduced alphabet and randomized for longer ones. Where both accept an
+// expression they have to select the same channels; parseChannelRange may only reject expressions the old code
+// rejected as well or accepted by silently ignoring or joining parts of them.
+
+#include <helper.hpp>
+
+#include <vector>
+#include <string>
+#include <random>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "testing.hpp"
+
+namespace baseline {
+  /// expandRange before parseChannelRange
+  std::vector<int> expandRange(std::string range){
+    // clean input of spaces
+    boost::erase_all(range," ");
+    // helper vars
+    std::vector<std::string> strs,r;
+    std::vector<int> v;
+    int low,high,i;
+    // split string
+    boost::split(strs,range,boost::is_any_of(","));
+    // expand values
+    for (auto it:strs){
+      boost::split(r,it,boost::is_any_of("-"));
+      auto x = r.begin();
+      low = high =boost::lexical_cast<int>(r[0]);
+      x++;
+      if(x!=r.end())
+        high = boost::lexical_cast<int>(r[1]);
+      for(i=low;i<=high;++i)
+        v.push_back(i);
+    }
+    return v;
+  }
+
+  /// the range handling of settingsBase::parseSetting before parseChannelRange: channels selected, false if rejected
+  bool parse(const std::string& range, std::size_t nChannels, std::vector<bool>& channels, bool& outOfRange){
+    channels.assign(nChannels, false);
+    outOfRange = false;
+    if (range.empty() || !boost::all(range, boost::is_any_of(",-*") || boost::is_digit() || boost::is_space()))
+      return false;
+    if (boost::find_first(range, "*")){
+      channels.assign(nChannels, true);
+      return true;
+    }
+    std::vector<int> v;
+    try{
+      v = expandRange(range);
+    }
+    catch (boost::bad_lexical_cast&){
+      return false;
+    }
+    for (int x : v){
+      if (x >= 0 && (std::size_t)x < nChannels)
+        channels[x] = true;
+      else
+        outOfRange = true;
+    }
+    return true;
+  }
+}
+
+/// whether the old code accepted the expression only by ignoring or joining parts of it, which parseChannelRange rejects
+static bool deliberatelyRejected(const std::string& range){
+  // anything along with '*' was ignored
+  if (range.find('*') != std::string::npos)
+    return true;
+  // numbers separated by spaces only were joined ("1 2" read as 12)
+  std::string noSpaces = boost::erase_all_copy(range, " ");
+  for (std::size_t i = 0; i < range.size(); i++){
+    std::size_t next = range.find_first_not_of(' ', i + 1);
+    if (isdigit(range[i]) && next != i + 1 && next != std::string::npos && isdigit(range[next]))
+      return true;
+  }
+  std::vector<std::string> items;
+  boost::split(items, noSpaces, boost::is_any_of(","));
+  for (auto& item : items){
+    std::vector<std::string> bounds;
+    boost::split(bounds, item, boost::is_any_of("-"));
+    // everything after a second '-' was ignored
+    if (bounds.size() > 2)
+      return true;
+    // a range ending before it starts selected nothing
+    if (bounds.size() == 2 && !bounds[0].empty() && !bounds[1].empty() && std::stoi(bounds[1]) < std::stoi(bounds[0]))
+      return true;
+  }
+  return false;
+}
+
+static void checkRange(const std::string& range, std::size_t nChannels){
+  std::vector<bool> expected;
+  bool expectedOutOfRange;
+  bool oldAccepts = baseline::parse(range, nChannels, expected, expectedOutOfRange);
+
+  std::vector<uint64_t> mask((nChannels + 63)/64, 0);
+  rangeError error;
+  bool outOfRange = false;
+  bool accepts = parseChannelRange(range.data(), range.data() + range.size(), nChannels, mask.data(), error,
+                                   [&](uint64_t, uint64_t){ outOfRange = true; });
+  if (accepts){
+    CADIDAQ_CHECK_EQUAL(oldAccepts, true, "'" << range << "' for " << nChannels << " channels");
+    if (!oldAccepts)
+      return;
+    for (std::size_t i = 0; i < nChannels; i++)
+      CADIDAQ_CHECK_EQUAL(bool((mask[i/64] >> (i%64)) & 1), expected[i], "channel " << i << " of '" << range << "'");
+    // (the old code ignored the channels listed along with '*')
+    if (range.find('*') == std::string::npos)
+      CADIDAQ_CHECK_EQUAL(outOfRange, expectedOutOfRange, "channels beyond " << nChannels << " in '" << range << "'");
+  } else {
+    CADIDAQ_CHECK(error.position <= range.size());
+    if (oldAccepts)
+      CADIDAQ_CHECK_EQUAL(deliberatelyRejected(range), true, "'" << range << "' rejected: " << error.message);
+  }
+}
+
+/// longest run of digits (the old code expanded ranges channel by channel, so numbers are kept short)
+static std::size_t longestNumber(const std::string& range){
+  std::size_t run = 0, longest = 0;
+  for (char c : range){
+    run = isdigit(c) ? run + 1 : 0;
+    longest = std::max(longest, run);
+  }
+  return longest;
+}
+
+int main(){
+  // all expressions of up to 5 characters of a reduced alphabet, for boards of 8 and 64 channels
+  const std::string small = "019,- *";
+  std::vector<std::string> level(1, "");
+  for (std::size_t length = 0; length <= 5; length++){
+    std::vector<std::string> next;
+    for (auto& range : level){
+      checkRange(range, 8);
+      checkRange(range, 64);
+      for (char c : small)
+        next.push_back(range + c);
+    }
+    level.swap(next);
+  }
+
+  // random expressions of up to 16 characters
+  const std::string alphabet = "0123456789,-* ";
+  std::mt19937_64 rng(18);
+  for (int r = 0; r < 50000; r++){
+    std::string range;
+    std::size_t length = rng() % 17;
+    for (std::size_t i = 0; i < length; i++)
+      range += rng() % 3 == 0 ? alphabet[10 + rng() % 4] : alphabet[rng() % 10];
+    if (longestNumber(range) > 3)
+      continue;
+    checkRange(range, 1 + rng() % 130);
+  }
+
+  // the error position points at the offending part
+  rangeError error;
+  uint64_t mask[1] = {0};
+  std::string range = "1-3,5-x";
+  CADIDAQ_CHECK(!parseChannelRange(range.data(), range.data() + range.size(), 64, mask, error, [](uint64_t, uint64_t){}));
+  CADIDAQ_CHECK_EQUAL(error.position, 6u, error.message);
+  return cadidaq::testResult();
+}
@@ -0,0 +1,229 @@
+// dppDecoder.cpp
+// dppDecoder::decode on synthetic board aggregates of all supported DPP firmwares, for every combination of the
+// fields a hit can carry: decoded hits have to match the generated ones. Corrupted and truncated buffers have to be
+// abandoned without reading outside of them (best run with a sanitizer).
+
+#include <eventDecoder.hpp>
+#include <digitizer.hpp> // boardInfo
+
+#include <vector>
+#include <random>
+#include <cstring>
+
+#include "testing.hpp"
+
+/// a hit as written into the synthetic aggregates
+struct generatedHit {
+  uint32_t channel;
+  uint64_t timeTag; ///< 47 bits
+  uint16_t energy;
+  uint16_t chargeLong;
+  bool     pileup;
+  uint16_t fineTime;
+  uint16_t extrasFlags;
+};
+
+/// word 0 of a channel aggregate: bit 31 set, size in words
+static const uint32_t channelAggregateFlag = 0x80000000;
+/// bits of the format word of a channel aggregate
+static const uint32_t energyBit = 1u << 30, timeBit = 1u << 29, extrasBit = 1u << 28, samplesBit = 1u << 27;
+static const uint32_t boardId = 3;
+
+/** board aggregates with hits of the given format in random channels (pairs of channels if pairs is set); sample i of
+    a hit of channel ch is (ch + i) & 0x3FFF */
+static std::vector<uint32_t> generate(std::mt19937& rng, bool pairs, bool psd, uint32_t format, uint32_t nAggregates, std::vector<generatedHit>& hits){
+  std::vector<uint32_t> out;
+  uint32_t nSamples = (format & samplesBit) ? (format & 0xFFFF)*8 : 0;
+  for (uint32_t a = 0; a < nAggregates; a++){
+    std::size_t start = out.size();
+    out.resize(start + 4);
+    uint32_t mask = rng() & 0xFF;
+    for (uint32_t bit = 0; bit < 8; bit++){
+      if (!((mask >> bit) & 1))
+        continue;
+      std::size_t channelStart = out.size();
+      out.push_back(0);
+      out.push_back(format);
+      for (uint32_t n = 1 + rng() % 5; n > 0; n--){
+        generatedHit h;
+        // the odd channel of a pair is only told by the time tag word
+        h.channel = bit*(pairs ? 2 : 1) + (pairs && (format & timeBit) ? rng() % 2 : 0);
+        h.timeTag = ((uint64_t)rng() << 16 ^ rng()) & ((uint64_t(1) << 47) - 1);
+        h.energy = rng() & 0x7FFF;
+        h.chargeLong = rng();
+        h.pileup = rng() & 1;
+        h.fineTime = rng() & 0x3FF;
+        h.extrasFlags = rng() & 0xFC00;
+        if (format & timeBit)
+          out.push_back((pairs ? (h.channel & 1) << 31 : 0) | (h.timeTag & 0x7FFFFFFF));
+        for (uint32_t i = 0; i < nSamples; i += 2)
+          out.push_back(((h.channel + i) & 0x3FFF) | ((h.channel + i + 1) & 0x3FFF) << 16);
+        if (format & extrasBit)
+          out.push_back((uint32_t)(h.timeTag >> 31) << 16 | h.extrasFlags | h.fineTime);
+        if (format & energyBit)
+          out.push_back((psd ? (uint32_t)h.chargeLong << 16 : 0) | (uint32_t)h.pileup << 15 | h.energy);
+        hits.push_back(h);
+      }
+      out[channelStart] = channelAggregateFlag | (out.size() - channelStart);
+    }
+    out[start] = 0xA0000000 | (out.size() - start);
+    out[start + 1] = boardId << 27 | mask;
+    out[start + 2] = a;
+    out[start + 3] = 0;
+  }
+  return out;
+}
+
+static cadidaq::boardInfo dppBoard(const char* amcFirmware){
+  cadidaq::boardInfo info = {};
+  info.hasDppFw = true;
+  info.amcFirmware = amcFirmware;
+  info.adcBits = 14;
+  return info;
+}
+
+struct firmware {
+  const char* amc;
+  bool        pairs;
+  bool        psd;
+};
+
+/// all combinations of save parameter, waveforms and extras word on all firmwares
+static void decodeAllFormats(std::mt19937& rng){
+  const firmware firmwares[] = {{"131.6", false, true}, {"132.1", false, true}, {"128.64", false, false}, {"136.4", true, true}, {"139.2", true, false}};
+  const CAEN_DGTZ_DPP_SaveParam_t saveParams[] = {CAEN_DGTZ_DPP_SAVE_PARAM_EnergyOnly, CAEN_DGTZ_DPP_SAVE_PARAM_TimeOnly,
+                                                  CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime, CAEN_DGTZ_DPP_SAVE_PARAM_None};
+  for (auto& fw : firmwares){
+    cadidaq::boardInfo info = dppBoard(fw.amc);
+    CADIDAQ_CHECK(cadidaq::dppDecoder::supports(info));
+    for (auto saveParam : saveParams){
+      for (int waveforms = 0; waveforms < 2; waveforms++){
+        for (int extras = 0; extras < 2; extras++){
+          bool time = saveParam == CAEN_DGTZ_DPP_SAVE_PARAM_TimeOnly || saveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime;
+          bool energy = saveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyOnly || saveParam == CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime;
+          uint32_t format = (energy ? energyBit : 0) | (time ? timeBit : 0) | (extras ? extrasBit : 0) | (waveforms ? samplesBit | 3 : 0);
+          // hits without any field do not exist
+          if (!(format & (energyBit | timeBit | extrasBit | samplesBit)))
+            continue;
+          std::vector<generatedHit> hits;
+          std::vector<uint32_t> buffer = generate(rng, fw.pairs, fw.psd, format, 200, hits);
+          CAEN_DGTZ_DPP_AcqMode_t acqMode = waveforms ? CAEN_DGTZ_DPP_ACQ_MODE_Mixed : CAEN_DGTZ_DPP_ACQ_MODE_List;
+          cadidaq::dppDecoder decoder(info, saveParam, acqMode);
+          cadidaq::timestampExtender reference(extras ? 47 : 31);
+          std::size_t i = 0;
+          uint32_t n = decoder.decode(reinterpret_cast<const char*>(buffer.data()), buffer.size()*4, [&](const cadidaq::dppHit& hit){
+            if (i >= hits.size())
+              return;
+            const generatedHit& g = hits[i++];
+            uint64_t timeTag = (g.timeTag & 0x7FFFFFFF) | (extras ? g.timeTag >> 31 << 31 : 0);
+            uint16_t flags = (extras ? g.extrasFlags : 0) | (time ? cadidaq::dppHit::TIME : 0)
+              | (energy ? cadidaq::dppHit::ENERGY | (g.pileup ? cadidaq::dppHit::PILEUP : 0) : 0);
+            CADIDAQ_CHECK_EQUAL((uint32_t)hit.boardId, boardId, fw.amc);
+            CADIDAQ_CHECK_EQUAL((uint32_t)hit.channel, time ? g.channel : g.channel & ~(fw.pairs ? 1u : 0u), fw.amc);
+            CADIDAQ_CHECK_EQUAL(hit.timeTag, time ? reference.extend(timeTag) : 0, fw.amc);
+            CADIDAQ_CHECK_EQUAL(hit.energy, energy ? g.energy : 0, fw.amc);
+            CADIDAQ_CHECK_EQUAL(hit.chargeLong, energy && fw.psd ? g.chargeLong : 0, fw.amc);
+            CADIDAQ_CHECK_EQUAL(hit.fineTime, extras ? g.fineTime : 0, fw.amc);
+            CADIDAQ_CHECK_EQUAL(hit.flags, flags, fw.amc);
+            CADIDAQ_CHECK_EQUAL(hit.nSamples, waveforms ? 24 : 0, fw.amc);
+            cadidaq::channelData samples = decoder.waveform(reinterpret_cast<const char*>(buffer.data()), hit);
+            for (uint32_t s = 0; s < samples.nSamples; s++)
+              CADIDAQ_CHECK_EQUAL(samples.sample(s), (g.channel + s) & 0x3FFF, fw.amc << " sample " << s);
+          });
+          CADIDAQ_CHECK_EQUAL(n, hits.size(), fw.amc);
+          CADIDAQ_CHECK_EQUAL(i, hits.size(), fw.amc);
+          CADIDAQ_CHECK_EQUAL(decoder.getCorruptBuffers(), 0u, fw.amc);
+          CADIDAQ_CHECK_EQUAL(decoder.getUnexpectedHits(), 0u, fw.amc);
+
+          // a configuration not matching the format is counted, but the hits are decoded
+          cadidaq::dppDecoder other(info, saveParam, waveforms ? CAEN_DGTZ_DPP_ACQ_MODE_List : CAEN_DGTZ_DPP_ACQ_MODE_Mixed);
+          CADIDAQ_CHECK_EQUAL(other.decode(reinterpret_cast<const char*>(buffer.data()), buffer.size()*4, [](const cadidaq::dppHit&){}), hits.size(), fw.amc);
+          CADIDAQ_CHECK_EQUAL(other.getUnexpectedHits(), hits.size(), fw.amc);
+        }
+      }
+    }
+  }
+}
+
+/// hits of aggregates following a corrupt header are dropped with the rest of the buffer
+static void corruptHeaders(std::mt19937& rng){
+  cadidaq::boardInfo info = dppBoard("131.6");
+  const uint32_t format = energyBit | timeBit | samplesBit | 1;
+  std::vector<generatedHit> hits;
+  std::vector<uint32_t> buffer = generate(rng, false, true, format, 1, hits);
+  std::size_t secondAggregate = buffer.size();
+  std::vector<generatedHit> more;
+  std::vector<uint32_t> second = generate(rng, false, true, format, 1, more);
+  buffer.insert(buffer.end(), second.begin(), second.end());
+  auto decode = [&](const std::vector<uint32_t>& b, cadidaq::dppDecoder& decoder){
+    return decoder.decode(reinterpret_cast<const char*>(b.data()), b.size()*4, [](const cadidaq::dppHit&){});
+  };
+
+  // board aggregate of another type
+  std::vector<uint32_t> b = buffer;
+  b[secondAggregate] = (b[secondAggregate] & 0x0FFFFFFF) | 0x50000000;
+  cadidaq::dppDecoder wrongType(info, CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime, CAEN_DGTZ_DPP_ACQ_MODE_Mixed);
+  CADIDAQ_CHECK_EQUAL(decode(b, wrongType), hits.size(), "");
+  CADIDAQ_CHECK_EQUAL(wrongType.getCorruptBuffers(), 1u, "");
+
+  // board aggregate claiming more words than the buffer holds
+  b = buffer;
+  b[secondAggregate] += b.size();
+  cadidaq::dppDecoder tooLong(info, CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime, CAEN_DGTZ_DPP_ACQ_MODE_Mixed);
+  CADIDAQ_CHECK_EQUAL(decode(b, tooLong), hits.size(), "");
+  CADIDAQ_CHECK_EQUAL(tooLong.getCorruptBuffers(), 1u, "");
+
+  // a waveform of more samples than a hit can describe: (format & 0xFFFF)*8 beyond 16 bits
+  std::vector<uint32_t> huge(4 + 2 + 1 + 0x2000*4, 0);
+  huge[0] = 0xA0000000 | huge.size();
+  huge[1] = boardId << 27 | 1;
+  huge[4] = channelAggregateFlag | (huge.size() - 4);
+  huge[5] = timeBit | samplesBit | 0x2000;
+  cadidaq::dppDecoder tooManySamples(info, CAEN_DGTZ_DPP_SAVE_PARAM_TimeOnly, CAEN_DGTZ_DPP_ACQ_MODE_Mixed);
+  CADIDAQ_CHECK_EQUAL(decode(huge, tooManySamples), 0u, "");
+  CADIDAQ_CHECK_EQUAL(tooManySamples.getCorruptBuffers(), 1u, "");
+  // while the longest waveform described by 16 bits is decoded
+  huge[5] = timeBit | samplesBit | 0x1FFF;
+  huge.resize(4 + 2 + 1 + 0x1FFF*4);
+  huge[0] = 0xA0000000 | huge.size();
+  huge[4] = channelAggregateFlag | (huge.size() - 4);
+  cadidaq::dppDecoder longest(info, CAEN_DGTZ_DPP_SAVE_PARAM_TimeOnly, CAEN_DGTZ_DPP_ACQ_MODE_Mixed);
+  uint32_t nSamples = 0;
+  CADIDAQ_CHECK_EQUAL(longest.decode(reinterpret_cast<const char*>(huge.data()), huge.size()*4, [&](const cadidaq::dppHit& hit){ nSamples = hit.nSamples; }), 1u, "");
+  CADIDAQ_CHECK_EQUAL(nSamples, 0x1FFFu*8, "");
+  CADIDAQ_CHECK_EQUAL(longest.getCorruptBuffers(), 0u, "");
+}
+
+/// random bit flips and truncation: the decoder must stay inside the buffer and decode at most the hits generated
+static void fuzz(std::mt19937& rng){
+  cadidaq::boardInfo info = dppBoard("136.1");
+  for (int r = 0; r < 20000; r++){
+    std::vector<generatedHit> hits;
+    std::vector<uint32_t> buffer = generate(rng, true, true, energyBit | timeBit | extrasBit | samplesBit | 1, 3, hits);
+    for (int k = rng() % 4; k >= 0; k--)
+      buffer[rng() % buffer.size()] ^= 1u << (rng() % 32);
+    std::size_t bytes = rng() % 4 == 0 ? rng() % (buffer.size()*4 + 1) : buffer.size()*4;
+    // a copy of exactly that size, so that a sanitizer catches any read beyond it
+    std::vector<uint32_t> exact((bytes + 3)/4);
+    std::memcpy(exact.data(), buffer.data(), bytes);
+    const char* data = reinterpret_cast<const char*>(exact.data());
+    cadidaq::dppDecoder decoder(info, CAEN_DGTZ_DPP_SAVE_PARAM_EnergyAndTime, CAEN_DGTZ_DPP_ACQ_MODE_Mixed);
+    uint64_t sum = 0;
+    uint32_t n = decoder.decode(data, bytes, [&](const cadidaq::dppHit& hit){
+      cadidaq::channelData samples = decoder.waveform(data, hit);
+      CADIDAQ_CHECK(hit.waveform + samples.nSamples/2 <= exact.size());
+      for (uint32_t s = 0; s < samples.nSamples; s++)
+        sum += samples.sample(s);
+    });
+    CADIDAQ_CHECK(n <= exact.size());
+    CADIDAQ_CHECK(decoder.getCorruptBuffers() <= 1);
+  }
+}
+
+int main(){
+  std::mt19937 rng(22);
+  decodeAllFormats(rng);
+  corruptHeaders(rng);
+  fuzz(rng);
+  return cadidaq::testResult();
+}
@@ -0,0 +1,58 @@
+// integers.cpp
+// Parsing and formatting of integers in the configuration (parseInteger, str2hex and hex2str in helper.hpp and the
+// hexTranslator used for all int and uint32_t settings): round trips over the full range of uint32_t, the limits of
+// int and the strict rejection of everything that is not a complete number.
+
+#include <hexTranslator.hpp>
+#include <helper.hpp>
+
+#include <string>
+#include <limits>
+#include <cstdio>
+
+#include "testing.hpp"
+
+int main(){
+  hexTranslator<uint32_t> unsignedTranslator;
+  hexTranslator<int> signedTranslator;
+
+  // round trips, spread over the full range (every 65521st value and the neighbourhood of 0 and of the maximum)
+  auto roundTrip = [&](uint32_t v){
+    std::string hex = hex2str(v);
+    char expected[16];
+    std::snprintf(expected, sizeof(expected), "0x%x", v);
+    CADIDAQ_CHECK_EQUAL(hex, std::string(expected), "");
+    CADIDAQ_CHECK_EQUAL(str2hex(hex).value_or(v + 1), v, hex);
+    CADIDAQ_CHECK_EQUAL(str2hex(std::to_string(v)).value_or(v + 1), v, v);
+    CADIDAQ_CHECK_EQUAL(unsignedTranslator.get_value(hex).value_or(v + 1), v, hex);
+    CADIDAQ_CHECK_EQUAL(unsignedTranslator.get_value(std::to_string(v)).value_or(v + 1), v, v);
+    CADIDAQ_CHECK_EQUAL(*unsignedTranslator.put_value(v), std::to_string(v), "");
+  };
+  for (uint64_t v = 0; v <= std::numeric_limits<uint32_t>::max(); v += 65521)
+    roundTrip(v);
+  for (uint32_t v = 0; v < 4096; v++){
+    roundTrip(v);
+    roundTrip(std::numeric_limits<uint32_t>::max() - v);
+  }
+  // hex digits in either case, and the prefix as well
+  CADIDAQ_CHECK_EQUAL(str2hex("0xabcDEF").value_or(0), 0xABCDEFu, "");
+  CADIDAQ_CHECK_EQUAL(str2hex("0XFF").value_or(0), 0xFFu, "");
+  CADIDAQ_CHECK_EQUAL(str2hex("  0x10 ").value_or(0), 0x10u, "surrounding spaces");
+
+  // limits of signed settings
+  CADIDAQ_CHECK_EQUAL(signedTranslator.get_value("-2147483648").value_or(0), std::numeric_limits<int>::min(), "");
+  CADIDAQ_CHECK_EQUAL(signedTranslator.get_value("2147483647").value_or(0), std::numeric_limits<int>::max(), "");
+  CADIDAQ_CHECK_EQUAL(signedTranslator.get_value("0x7FFFFFFF").value_or(0), std::numeric_limits<int>::max(), "");
+  CADIDAQ_CHECK(!signedTranslator.get_value("2147483648"));
+  CADIDAQ_CHECK(!signedTranslator.get_value("-2147483649"));
+
+  // anything but a complete number is rejected, in particular trailing characters after hex digits
+  const char* rejected[] = {"", " ", "0x", "-", "+", "-1", "x10", "0x1g", "0x9FAt", "12a", "1 2", "0x 1",
+                            "4294967296", "0x100000000", "99999999999999999999"};
+  for (const char* str : rejected){
+    CADIDAQ_CHECK_EQUAL(bool(unsignedTranslator.get_value(str)), false, "'" << str << "'");
+    CADIDAQ_CHECK_EQUAL(bool(str2hex(std::string(str))), false, "'" << str << "'");
+  }
+  CADIDAQ_CHECK(!signedTranslator.get_value("0x9FAt"));
+  return cadidaq::testResult();
+}
@@ -0,0 +1,136 @@
+// masks.cpp
+// Property tests of the word-wise channel mask conversions (vec2Mask, expandMask and mask2Vec in helper.hpp,
+// compressGroups and expandGroups in channelVector.hpp) against the channel-by-channel loops they replaced: exhaustive
+// over the group masks of all group sizes up to 64 and over all true/false/unset patterns of up to 9 channels, and
+// randomized for vectors of up to 130 channels.
+
+#include <helper.hpp>
+#include <channelVector.hpp>
+
+#include <vector>
+#include <random>
+
+#include "testing.hpp"
+
+typedef std::vector<boost::optional<bool>> optionalBools;
+
+namespace baseline {
+  /// vec2Mask as before channelVector: bit index/groupSize set for every channel set to 'true' (widened to 64 bits)
+  uint64_t vec2Mask(const optionalBools& vec, uint groupSize){
+    uint64_t mask = 0;
+    for (std::size_t index = 0; index < vec.size(); index++)
+      if (vec[index] && *vec[index] && index/groupSize < 64)
+        mask |= uint64_t(1) << (index/groupSize);
+    return mask;
+  }
+
+  /// mask2Vec as before channelVector (widened to 64 bits)
+  void mask2Vec(boost::optional<uint64_t> mask, optionalBools& vec, uint groupSize){
+    for (std::size_t index = 0; index < vec.size(); index++){
+      if (!mask)
+        vec[index] = boost::none;
+      else
+        vec[index] = index/groupSize < 64 && ((*mask >> (index/groupSize)) & 1);
+    }
+  }
+
+  uint64_t compressGroups(uint64_t bits, std::size_t groupSize){
+    uint64_t groups = 0;
+    for (std::size_t i = 0; i < 64; i++)
+      if ((bits >> i) & 1)
+        groups |= uint64_t(1) << (i/groupSize);
+    return groups;
+  }
+
+  uint64_t expandGroups(uint64_t groups, std::size_t groupSize){
+    uint64_t bits = 0;
+    for (std::size_t i = 0; i < 64; i++)
+      if (i/groupSize < 64 && ((groups >> (i/groupSize)) & 1))
+        bits |= uint64_t(1) << i;
+    return bits;
+  }
+}
+
+static cadidaq::channelVector<bool> toChannelVector(const optionalBools& vec){
+  cadidaq::channelVector<bool> channels(vec.size());
+  for (std::size_t i = 0; i < vec.size(); i++)
+    channels.assign(i, vec[i]);
+  return channels;
+}
+
+/// all conversions of one vector for all group sizes from 1 to one beyond the size of the vector
+static void checkVector(const optionalBools& vec){
+  cadidaq::channelVector<bool> channels = toChannelVector(vec);
+  for (uint groupSize = 1; groupSize <= vec.size() + 1; groupSize++){
+    uint64_t mask = vec2Mask(channels, groupSize);
+    CADIDAQ_CHECK_EQUAL(mask, baseline::vec2Mask(vec, groupSize), "vec2Mask of " << vec.size() << " channels, groups of " << groupSize);
+    // the groups expand into exactly their channels
+    CADIDAQ_CHECK_EQUAL(expandMask(mask, groupSize), baseline::expandGroups(mask, groupSize), "expandMask, groups of " << groupSize);
+    // and back into a vector
+    optionalBools expected(vec.size());
+    baseline::mask2Vec(mask, expected, groupSize);
+    cadidaq::channelVector<bool> back(vec.size());
+    mask2Vec(mask, back, groupSize);
+    for (std::size_t i = 0; i < vec.size(); i++)
+      CADIDAQ_CHECK(back[i] == expected[i]);
+  }
+}
+
+int main(){
+  // compressGroups and expandGroups: all group masks of the group sizes with up to 16 groups, random masks otherwise
+  std::mt19937_64 rng(17);
+  for (std::size_t groupSize = 1; groupSize <= 64; groupSize++){
+    std::size_t nGroups = (64 + groupSize - 1)/groupSize;
+    bool exhaustive = nGroups <= 16;
+    uint64_t nMasks = exhaustive ? uint64_t(1) << nGroups : 1 << 16;
+    for (uint64_t m = 0; m < nMasks; m++){
+      uint64_t groups = exhaustive ? m : rng() & cadidaq::detail::lowBits(nGroups);
+      uint64_t bits = baseline::expandGroups(groups, groupSize);
+      CADIDAQ_CHECK_EQUAL(cadidaq::detail::expandGroups(groups, groupSize), bits, "groups of " << groupSize);
+      CADIDAQ_CHECK_EQUAL(cadidaq::detail::compressGroups(bits, groupSize), groups, "groups of " << groupSize);
+      // any channel of a group marks the group
+      uint64_t some = bits & rng();
+      CADIDAQ_CHECK_EQUAL(cadidaq::detail::compressGroups(some, groupSize), baseline::compressGroups(some, groupSize), "groups of " << groupSize);
+    }
+  }
+
+  // all true/false/unset patterns of up to 9 channels
+  for (std::size_t n = 1; n <= 9; n++){
+    std::size_t patterns = 1;
+    for (std::size_t i = 0; i < n; i++)
+      patterns *= 3;
+    optionalBools vec(n);
+    for (std::size_t p = 0; p < patterns; p++){
+      std::size_t digits = p;
+      for (std::size_t i = 0; i < n; i++, digits /= 3)
+        vec[i] = digits % 3 == 0 ? boost::optional<bool>() : boost::optional<bool>(digits % 3 == 2);
+      checkVector(vec);
+    }
+  }
+
+  // random patterns of up to 130 channels, covering boards with 64 channels and vectors spanning several words
+  for (int r = 0; r < 2000; r++){
+    optionalBools vec(r % 4 == 0 ? 64 : 1 + rng() % 130);
+    for (auto& v : vec){
+      int state = rng() % 3;
+      v = state == 0 ? boost::optional<bool>() : boost::optional<bool>(state == 2);
+    }
+    checkVector(vec);
+  }
+
+  // random 64-bit masks as read back from the device
+  for (int r = 0; r < 20000; r++){
+    uint64_t mask = rng();
+    uint groupSize = 1 + rng() % 64;
+    optionalBools expected(1 + rng() % 130);
+    baseline::mask2Vec(mask, expected, groupSize);
+    cadidaq::channelVector<bool> vec(expected.size());
+    mask2Vec(mask, vec, groupSize);
+    for (std::size_t i = 0; i < vec.size(); i++)
+      CADIDAQ_CHECK(vec[i] == expected[i]);
+  }
+  cadidaq::channelVector<bool> vec(40);
+  mask2Vec(boost::none, vec, 8);
+  CADIDAQ_CHECK_EQUAL(vec.countSet(), 0u, "mask2Vec of an unknown mask");
+  return cadidaq::testResult();
+}
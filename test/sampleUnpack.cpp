@@ -0,0 +1,113 @@
+// sampleUnpack.cpp
+// Bit-exact comparison of the unpack kernels (sampleUnpack.hpp) with the scalar kernel and with channelData::sample():
+// every layout, every sub-channel of a group and every number of samples up to several vectors (so every residue left
+// to the scalar remainder), for all instruction sets the CPU supports. The input is allocated to its exact size and
+// the output is guarded on both sides, so reads and writes beyond either show up (with the sanitizers, or as changed
+// guards). Also the alignment and padding of sampleBuffer.
+
+#include <sampleUnpack.hpp>
+
+#include <vector>
+#include <random>
+#include <cstdint>
+
+#include "testing.hpp"
+
+using cadidaq::channelData;
+using cadidaq::sampleLayout;
+using cadidaq::simdLevel;
+
+static const uint16_t guard = 0xBEEF;
+
+/// words holding nSamples samples of the layout (for GROUP_12 the blocks of all channels of the group)
+static uint32_t wordsFor(sampleLayout layout, uint32_t nSamples){
+  switch (layout){
+  case sampleLayout::PAIRS:    return (nSamples + 1)/2;
+  case sampleLayout::TRIPLETS: return (nSamples + 2)/3;
+  default:                     return (nSamples + 2)/3*9;
+  }
+}
+
+static const char* layoutName(sampleLayout layout){
+  switch (layout){
+  case sampleLayout::PAIRS:    return "PAIRS";
+  case sampleLayout::TRIPLETS: return "TRIPLETS";
+  default:                     return "GROUP_12";
+  }
+}
+
+/// output of the kernel for the channel, between guards
+static std::vector<uint16_t> run(cadidaq::unpackKernel kernel, const channelData& d){
+  std::vector<uint16_t> out(d.nSamples + 2 + 32, guard);
+  kernel(d, out.data() + 1);
+  return out;
+}
+
+static void checkChannel(const channelData& d, simdLevel maxLevel){
+  std::vector<uint16_t> expected = run(cadidaq::selectUnpackKernel(d.layout, simdLevel::SCALAR), d);
+  CADIDAQ_CHECK_EQUAL(expected[0], guard, "scalar kernel wrote before the output");
+  for (uint32_t i = 0; i < d.nSamples; i++)
+    CADIDAQ_CHECK_EQUAL(expected[i + 1], d.sample(i), "scalar " << layoutName(d.layout) << " sample " << i << " of " << d.nSamples);
+  for (std::size_t i = d.nSamples + 1; i < expected.size(); i++)
+    CADIDAQ_CHECK_EQUAL(expected[i], guard, "scalar kernel wrote beyond the output");
+
+  for (int level = (int)simdLevel::SSE2; level <= (int)maxLevel; level++){
+    std::vector<uint16_t> out = run(cadidaq::selectUnpackKernel(d.layout, (simdLevel)level), d);
+    for (std::size_t i = 0; i < out.size(); i++)
+      CADIDAQ_CHECK_EQUAL(out[i], expected[i], layoutName(d.layout) << " level " << level << ", sub-channel " << (int)d.subChannel
+                          << ", " << d.nSamples << " samples: element " << i << " (guard at 0)");
+  }
+}
+
+int main(){
+  simdLevel maxLevel = cadidaq::detectSimdLevel();
+  std::mt19937 rng(23);
+  const sampleLayout layouts[] = {sampleLayout::PAIRS, sampleLayout::TRIPLETS, sampleLayout::GROUP_12};
+  for (sampleLayout layout : layouts){
+    // 12- and 14-bit pairs, 10-bit triplets, 12-bit groups
+    std::vector<uint16_t> masks;
+    if (layout == sampleLayout::PAIRS)
+      masks = {0x3FFF, 0x0FFF};
+    else
+      masks.push_back(layout == sampleLayout::TRIPLETS ? 0x03FF : 0x0FFF);
+    uint32_t nSub = layout == sampleLayout::GROUP_12 ? 8 : 1;
+    // the vector loops advance by up to 24 samples: 0..199 covers every residue several times
+    for (uint32_t nSamples = 0; nSamples < 200; nSamples++)
+      for (uint32_t sub = 0; sub < nSub; sub++)
+        for (uint16_t mask : masks){
+          std::vector<uint32_t> words(wordsFor(layout, nSamples));
+          for (auto& w : words)
+            w = rng();
+          channelData d = {words.data(), nSamples, sub, mask, layout, (uint8_t)sub};
+          checkChannel(d, maxLevel);
+        }
+    // long channels
+    for (uint32_t nSamples : {1023u, 1024u, 1025u, 4098u}){
+      std::vector<uint32_t> words(wordsFor(layout, nSamples));
+      for (auto& w : words)
+        w = rng();
+      channelData d = {words.data(), nSamples, nSub - 1, masks[0], layout, (uint8_t)(nSub - 1)};
+      checkChannel(d, maxLevel);
+    }
+  }
+
+  // sampleBuffer: aligned, zero-padded to whole vectors, reused for channels of any length
+  cadidaq::sampleBuffer buffer;
+  for (uint32_t nSamples : {100u, 1u, 0u, 517u, 16u, 33u}){
+    std::vector<uint32_t> words(wordsFor(sampleLayout::PAIRS, nSamples));
+    for (auto& w : words)
+      w = rng();
+    channelData d = {words.data(), nSamples, 0, 0x3FFF, sampleLayout::PAIRS, 0};
+    const uint16_t* samples = buffer.unpack(d);
+    CADIDAQ_CHECK(samples == buffer.data());
+    CADIDAQ_CHECK_EQUAL(reinterpret_cast<uintptr_t>(samples) % cadidaq::sampleBuffer::alignment, 0u, nSamples << " samples");
+    CADIDAQ_CHECK_EQUAL(buffer.size(), nSamples, "");
+    CADIDAQ_CHECK_EQUAL(buffer.paddedSize() % cadidaq::sampleBuffer::vectorSamples, 0u, nSamples << " samples");
+    CADIDAQ_CHECK(buffer.paddedSize() >= nSamples && buffer.paddedSize() < nSamples + cadidaq::sampleBuffer::vectorSamples);
+    for (uint32_t i = 0; i < nSamples; i++)
+      CADIDAQ_CHECK_EQUAL(samples[i], d.sample(i), "sample " << i << " of " << nSamples);
+    for (uint32_t i = nSamples; i < buffer.paddedSize(); i++)
+      CADIDAQ_CHECK_EQUAL(samples[i], 0u, "padding after " << nSamples << " samples");
+  }
+  return cadidaq::testResult();
+}
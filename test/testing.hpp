@@ -0,0 +1,43 @@
+// testing.hpp
+// Minimal checks for the test programs in test/: failed checks are printed and counted, and testResult() gives the
+// exit code of the test.
+#ifndef CADIDAQ_TESTING_H
+#define CADIDAQ_TESTING_H
+
+#include <iostream>
+#include <cstdlib>
+
+namespace cadidaq {
+  inline int& testFailures(){
+    static int failures = 0;
+    return failures;
+  }
+  /// exit code of the test program: EXIT_FAILURE if any check failed
+  inline int testResult(){
+    if (testFailures() > 0)
+      std::cerr << testFailures() << " check(s) failed" << std::endl;
+    return testFailures() > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+}
+
+#define CADIDAQ_CHECK(cond)                                                                      \
+  do {                                                                                           \
+    if (!(cond)){                                                                                \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #cond << std::endl;         \
+      cadidaq::testFailures()++;                                                                 \
+    }                                                                                            \
+  } while (0)
+
+/// checks a == b, printing both values (and the context streamed into ctx) on failure
+#define CADIDAQ_CHECK_EQUAL(a, b, ctx)                                                           \
+  do {                                                                                           \
+    auto cadidaqA = (a);                                                                         \
+    auto cadidaqB = (b);                                                                         \
+    if (!(cadidaqA == cadidaqB)){                                                                \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #a " == " #b " ("           \
+                << cadidaqA << " != " << cadidaqB << ") " << ctx << std::endl;                    \
+      cadidaq::testFailures()++;                                                                 \
+    }                                                                                            \
+  } while (0)
+
+#endif
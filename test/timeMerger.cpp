@@ -0,0 +1,194 @@
+// timeMerger.cpp
+// Merging of synthetic record streams through timeMerger (timeMerger.hpp): sources interleaved with random lags within
+// the reorder window, equal times across and within sources, a source that stops early, a source that never sends and
+// a single source. The merged stream has to be the records sorted by time, ties going to the lower input and then to
+// the earlier arrival, with nothing late or forced out.
+
+#include <timeMerger.hpp>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "testing.hpp"
+
+namespace {
+  struct record {
+    uint64_t    time;
+    std::size_t input;
+    std::size_t arrival; ///< position in the order of the pushes
+  };
+
+  /// what came out of the merger, in the order it came out
+  struct mergedStream {
+    std::vector<record> records;
+    bool                inputsMatch = true; ///< every record was emitted with its own input
+  };
+}
+
+/// pushes the records in the given order, releasing after each push, and flushes at the end
+static mergedStream merge(cadidaq::timeMerger<record>& merger, std::vector<record>& pushes){
+  mergedStream out;
+  auto emit = [&out](const record& r, std::size_t input){
+    out.records.push_back(r);
+    out.inputsMatch = out.inputsMatch && r.input == input;
+  };
+  for (std::size_t i = 0; i < pushes.size(); i++){
+    pushes[i].arrival = i;
+    merger.push(pushes[i].input, pushes[i], emit);
+    merger.release(emit);
+  }
+  merger.flush(emit);
+  return out;
+}
+
+/// the records in the order the merge has to give them
+static std::vector<record> expected(std::vector<record> pushes){
+  std::sort(pushes.begin(), pushes.end(), [](const record& a, const record& b){
+      if (a.time != b.time)
+        return a.time < b.time;
+      if (a.input != b.input)
+        return a.input < b.input;
+      return a.arrival < b.arrival;
+    });
+  return pushes;
+}
+
+static void checkMerged(const cadidaq::timeMerger<record>& merger, std::vector<record> pushes, const mergedStream& out, const std::string& context){
+  std::vector<record> sorted = expected(pushes);
+  CADIDAQ_CHECK_EQUAL(out.records.size(), sorted.size(), context);
+  CADIDAQ_CHECK(out.inputsMatch);
+  for (std::size_t i = 0; i < out.records.size() && i < sorted.size(); i++){
+    if (out.records[i].arrival != sorted[i].arrival){
+      CADIDAQ_CHECK_EQUAL(out.records[i].arrival, sorted[i].arrival, context << ": record " << i << " of the merge");
+      break;
+    }
+  }
+  CADIDAQ_CHECK_EQUAL(merger.getMerged(), uint64_t(pushes.size()), context);
+  CADIDAQ_CHECK_EQUAL(merger.getLate(), 0u, context);
+  CADIDAQ_CHECK_EQUAL(merger.getForced(), 0u, context);
+  CADIDAQ_CHECK_EQUAL(merger.getBuffered(), 0u, context);
+}
+
+/// records of the inputs at random times up to `span`, pushed in the order of their time plus a random lag below the window
+static std::vector<record> lagged(std::mt19937_64& rng, std::size_t inputs, std::size_t n, uint64_t span, uint64_t window){
+  std::vector<std::pair<uint64_t, record>> arrivals;
+  for (std::size_t i = 0; i < n; i++){
+    record r = {rng() % span, rng() % inputs, 0};
+    arrivals.push_back(std::make_pair(r.time + rng() % window, r));
+  }
+  std::stable_sort(arrivals.begin(), arrivals.end(), [](const std::pair<uint64_t, record>& a, const std::pair<uint64_t, record>& b){ return a.first < b.first; });
+  std::vector<record> pushes;
+  for (auto& a : arrivals)
+    pushes.push_back(a.second);
+  return pushes;
+}
+
+static void interleavedSources(){
+  std::mt19937_64 rng(25);
+  for (std::size_t inputs : {2, 3, 8, 13}){
+    for (uint64_t window : {1, 10, 1000}){
+      // spans short enough for many records at the same time, across and within inputs, and long enough for none
+      for (uint64_t span : {100, 100000}){
+        cadidaq::timeMerger<record> merger(inputs, window);
+        std::vector<record> pushes = lagged(rng, inputs, 5000, span, window);
+        mergedStream out = merge(merger, pushes);
+        checkMerged(merger, pushes, out, "inputs " + std::to_string(inputs) + ", window " + std::to_string(window) + ", span " + std::to_string(span));
+      }
+    }
+  }
+}
+
+static void equalTimestamps(){
+  // every input sends the same times, some of them twice: ties go to the lower input, then to the earlier arrival
+  std::vector<record> pushes;
+  for (uint64_t t = 0; t < 20; t++)
+    for (std::size_t input : {3, 1, 2, 0, 1})
+      pushes.push_back(record{100 + t/2, input, 0});
+  cadidaq::timeMerger<record> merger(4, 5);
+  mergedStream out = merge(merger, pushes);
+  checkMerged(merger, pushes, out, "equal times");
+  for (std::size_t i = 1; i < out.records.size(); i++)
+    if (out.records[i].time == out.records[i - 1].time)
+      CADIDAQ_CHECK(out.records[i].input >= out.records[i - 1].input);
+}
+
+static void sourceDrainingEarly(){
+  // input 1 stops at a tenth of the run: the others go on being released instead of waiting for it
+  std::mt19937_64 rng(1);
+  const uint64_t window = 50;
+  std::vector<record> pushes = lagged(rng, 3, 10000, 1000000, window);
+  pushes.erase(std::remove_if(pushes.begin(), pushes.end(), [](const record& r){ return r.input == 1 && r.time > 100000; }), pushes.end());
+  cadidaq::timeMerger<record> merger(3, window);
+  std::size_t buffered = 0;
+  mergedStream out;
+  auto emit = [&out](const record& r, std::size_t input){
+    out.records.push_back(r);
+    out.inputsMatch = out.inputsMatch && r.input == input;
+  };
+  for (std::size_t i = 0; i < pushes.size(); i++){
+    pushes[i].arrival = i;
+    merger.push(pushes[i].input, pushes[i], emit);
+    merger.release(emit);
+    if (pushes[i].time > 200000)
+      buffered = std::max(buffered, merger.getBuffered());
+  }
+  // about the records of two windows at the rate of the remaining inputs
+  CADIDAQ_CHECK(buffered < 20);
+  merger.flush(emit);
+  checkMerged(merger, pushes, out, "input 1 stopping early");
+}
+
+static void emptySource(){
+  // input 2 of 4 never sends: the merge neither waits for it nor emits anything for it
+  std::mt19937_64 rng(2);
+  std::vector<record> pushes = lagged(rng, 3, 3000, 100000, 20);
+  for (auto& r : pushes)
+    if (r.input == 2)
+      r.input = 3;
+  cadidaq::timeMerger<record> merger(4, 20);
+  mergedStream out = merge(merger, pushes);
+  checkMerged(merger, pushes, out, "empty input");
+  CADIDAQ_CHECK(merger.highWaterMark() < 20);
+  for (auto& r : out.records)
+    CADIDAQ_CHECK(r.input != 2);
+
+  // no input sending at all
+  cadidaq::timeMerger<record> idle(4, 20);
+  std::vector<record> none;
+  out = merge(idle, none);
+  CADIDAQ_CHECK(out.records.empty());
+}
+
+static void singleSource(){
+  // out of order within the window: sorted
+  std::mt19937_64 rng(3);
+  std::vector<record> pushes = lagged(rng, 1, 3000, 100000, 30);
+  cadidaq::timeMerger<record> merger(1, 30);
+  mergedStream out = merge(merger, pushes);
+  checkMerged(merger, pushes, out, "single input");
+
+  // behind a record already released: passed on at once and counted as late
+  cadidaq::timeMerger<record> late(1, 10);
+  std::vector<uint64_t> emitted;
+  auto emit = [&emitted](const record& r, std::size_t){ emitted.push_back(r.time); };
+  for (uint64_t t : {100, 105, 120, 95, 112, 130}){
+    late.push(0, record{t, 0, 0}, emit);
+    late.release(emit);
+  }
+  late.flush(emit);
+  CADIDAQ_CHECK_EQUAL(late.getLate(), 1u, "single input");
+  CADIDAQ_CHECK_EQUAL(late.getMerged(), 5u, "single input");
+  std::vector<uint64_t> order = {100, 105, 95, 112, 120, 130};
+  CADIDAQ_CHECK(emitted == order);
+}
+
+int main(){
+  interleavedSources();
+  equalTimestamps();
+  sourceDrainingEarly();
+  emptySource();
+  singleSource();
+  return cadidaq::testResult();
+}
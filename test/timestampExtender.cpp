@@ -0,0 +1,132 @@
+// timestampExtender.cpp
+// Synthetic wraparound sequences through timestampExtender (timestampExtender.hpp): counters of 8 to 47 bits, steps
+// up to the longest silence the extender tolerates, tags arriving out of order within the window, every pair of tags
+// of an 8-bit counter, changes of the counter's width (as DPP hits with and without the extras word cause) and reset().
+// True times are generated first; the extended tags have to equal them counted from the rollover before the first tag.
+
+#include <timestampExtender.hpp>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "testing.hpp"
+
+using cadidaq::timestampExtender;
+
+/// increasing times starting anywhere in the first three ranges of the counter, steps of up to maxStep ticks
+static std::vector<uint64_t> trueTimes(std::mt19937_64& rng, uint64_t range, uint64_t maxStep, std::size_t n){
+  std::vector<uint64_t> times;
+  uint64_t now = rng() % range + range*(rng() % 3);
+  for (std::size_t i = 0; i < n; i++){
+    times.push_back(now);
+    now += rng() % (maxStep + 1);
+  }
+  return times;
+}
+
+/// swaps neighbours at most `window` ticks apart, so that some tags arrive after later ones; returns the number of late tags
+static uint64_t shuffleWithin(std::vector<uint64_t>& times, uint64_t window){
+  for (std::size_t i = 1; i + 1 < times.size(); i += 3)
+    if (times[i + 1] - times[i] <= window)
+      std::swap(times[i], times[i + 1]);
+  uint64_t nLate = 0, latest = 0;
+  for (std::size_t i = 0; i < times.size(); i++){
+    if (i && times[i] < latest)
+      nLate++;
+    latest = std::max(latest, times[i]);
+  }
+  return nLate;
+}
+
+static void sequences(std::mt19937_64& rng, uint32_t bits){
+  uint64_t range = uint64_t(1) << bits, window = (range - 1) >> 3;
+  for (int s = 0; s < 100; s++){
+    // alternately long silences and tags out of order
+    bool silent = s % 2;
+    std::vector<uint64_t> times = trueTimes(rng, range, silent ? range - window - 1 : range/100 + 1, 2000);
+    std::vector<uint64_t> arrival = times;
+    uint64_t expectedLate = silent ? 0 : shuffleWithin(arrival, window);
+    // (the first tag may not be late: nothing is known before it)
+    if (arrival[0] != times[0])
+      continue;
+    uint64_t base = times[0] - times[0] % range, rollovers = times.back()/range - times[0]/range;
+
+    timestampExtender clock(bits);
+    for (std::size_t i = 0; i < arrival.size(); i++)
+      CADIDAQ_CHECK_EQUAL(clock.extend(arrival[i] & (range - 1)), arrival[i] - base, bits << " bits, sequence " << s << ", tag " << i);
+    CADIDAQ_CHECK_EQUAL(clock.getLateTags(), expectedLate, bits << " bits, sequence " << s);
+    CADIDAQ_CHECK_EQUAL(clock.getRollovers(), rollovers, bits << " bits, sequence " << s);
+    CADIDAQ_CHECK_EQUAL(clock.latest(), times.back() - base, bits << " bits, sequence " << s);
+    CADIDAQ_CHECK_EQUAL(clock.span(), times.back() - times[0], bits << " bits, sequence " << s);
+  }
+}
+
+/// tags of a counter switching between two widths, both taken from the same true time
+static void changingWidth(std::mt19937_64& rng, uint32_t narrow, uint32_t wide){
+  uint64_t narrowRange = uint64_t(1) << narrow, window = (narrowRange - 1) >> 3;
+  for (int s = 0; s < 100; s++){
+    bool silent = s % 2;
+    std::vector<uint64_t> times = trueTimes(rng, narrowRange, silent ? narrowRange - window - 1 : narrowRange/100 + 1, 2000);
+    std::vector<uint64_t> arrival = times;
+    uint64_t expectedLate = silent ? 0 : shuffleWithin(arrival, window);
+    if (arrival[0] != times[0])
+      continue;
+    // times count from the rollover before the first tag of the width it is read with
+    bool startWide = rng() % 2;
+    uint64_t firstRange = uint64_t(1) << (startWide ? wide : narrow);
+    uint64_t base = times[0] - times[0] % firstRange;
+
+    timestampExtender clock(startWide ? wide : narrow);
+    for (std::size_t i = 0; i < arrival.size(); i++){
+      if (i && rng() % 8 == 0)
+        clock.setBits(clock.bits() == narrow ? wide : narrow);
+      uint64_t tag = arrival[i] & ((uint64_t(1) << clock.bits()) - 1);
+      CADIDAQ_CHECK_EQUAL(clock.extend(tag), arrival[i] - base, narrow << "/" << wide << " bits, sequence " << s << ", tag " << i);
+    }
+    CADIDAQ_CHECK_EQUAL(clock.getLateTags(), expectedLate, narrow << "/" << wide << " bits, sequence " << s);
+    CADIDAQ_CHECK_EQUAL(clock.latest(), times.back() - base, narrow << "/" << wide << " bits, sequence " << s);
+    CADIDAQ_CHECK_EQUAL(clock.span(), times.back() - times[0], narrow << "/" << wide << " bits, sequence " << s);
+  }
+}
+
+int main(){
+  std::mt19937_64 rng(24);
+  for (uint32_t bits : {8u, 12u, 31u, 47u})
+    sequences(rng, bits);
+
+  // every (latest, next) pair of tags of an 8-bit counter (window 31)
+  for (uint64_t a = 0; a < 256; a++)
+    for (uint64_t b = 0; b < 256; b++){
+      timestampExtender clock(8);
+      clock.extend(a);
+      uint64_t ahead = (b - a) & 255;
+      uint64_t expected = ahead > 255 - 31 ? (a >= 256 - ahead ? a - (256 - ahead) : 0) : a + ahead;
+      CADIDAQ_CHECK_EQUAL(clock.extend(b), expected, a << " then " << b);
+      CADIDAQ_CHECK_EQUAL(clock.getLateTags(), ahead > 255 - 31 ? 1u : 0u, a << " then " << b);
+      CADIDAQ_CHECK_EQUAL(clock.getRollovers(), ahead <= 255 - 31 && b < a ? 1u : 0u, a << " then " << b);
+    }
+
+  // changes of the width keep the time, the late tags and the rollovers counted so far
+  changingWidth(rng, 8, 12);
+  changingWidth(rng, 31, 47);
+  timestampExtender clock(8);
+  for (uint64_t t = 0; t < 3*256; t += 100)
+    clock.extend(t);
+  clock.extend(690); // late
+  CADIDAQ_CHECK_EQUAL(clock.getRollovers(), 2u, "");
+  clock.setBits(12);
+  CADIDAQ_CHECK_EQUAL(clock.latest(), 700u, "");
+  CADIDAQ_CHECK_EQUAL(clock.extend(750), 750u, "");
+  CADIDAQ_CHECK_EQUAL(clock.getRollovers(), 2u, "");
+  CADIDAQ_CHECK_EQUAL(clock.getLateTags(), 1u, "");
+
+  // reset() forgets everything, including the counts
+  clock.reset();
+  CADIDAQ_CHECK_EQUAL(clock.getRollovers(), 0u, "after reset");
+  CADIDAQ_CHECK_EQUAL(clock.getLateTags(), 0u, "after reset");
+  CADIDAQ_CHECK_EQUAL(clock.latest(), 0u, "after reset");
+  CADIDAQ_CHECK_EQUAL(clock.extend(3000), 3000u, "first tag after reset");
+  CADIDAQ_CHECK_EQUAL(clock.span(), 0u, "after reset");
+  return cadidaq::testResult();
+}